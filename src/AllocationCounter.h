@@ -0,0 +1,63 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_ALLOCATIONCOUNTER_H
+#define LATTICES_ALLOCATIONCOUNTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Configure with -DLATTICES_COUNT_ALLOCATIONS=ON and every allocation gets
+// counted, by the operator new in LatticesEditor.cpp, on the thread that made
+// it. Each frame then logs how many it made, debug build or not. Painting a
+// lattice that hasn't changed should make none, so anything that shows up
+// there is worth a look.
+#ifndef LATTICES_COUNT_ALLOCATIONS
+#define LATTICES_COUNT_ALLOCATIONS 0
+#endif
+
+namespace lattices::allocations
+{
+// This thread's, so the audio thread's don't end up in a frame's count
+inline thread_local uint64_t count{0};
+
+// and what the tile workers made drawing for the frame that's painting, see
+// TileWorkers. Only they add to it, and only while the paint waits on them.
+inline std::atomic<uint64_t> lent{0};
+
+// Put one at the top of a paint() and it reports when it goes out of scope
+struct FrameCounter
+{
+#if LATTICES_COUNT_ALLOCATIONS
+    explicit FrameCounter(const char *w) : what(w), start(count), startLent(lent.load()) {}
+
+    ~FrameCounter()
+    {
+        auto n = (count - start) + (lent.load() - startLent);
+        if (n == 0)
+            return;
+
+        // after counting, so saying so isn't put down to the next frame
+        juce::Logger::writeToLog(juce::String(what) + ": " + juce::String(std::to_string(n)) +
+                                 " allocations");
+    }
+
+  private:
+    const char *what;
+    uint64_t start, startLent;
+#else
+    explicit FrameCounter(const char *) {}
+#endif
+};
+} // namespace lattices::allocations
+
+#endif // LATTICES_ALLOCATIONCOUNTER_H
@@ -0,0 +1,83 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_CHANGEBUS_H
+#define LATTICES_CHANGEBUS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include <juce_core/juce_core.h>
+
+namespace lattices
+{
+// How the processor tells the editor something changed. Changes get
+// published from whichever thread, the audio one included, and each topic
+// counts its own. Publishing only sets bits, so it never posts a message or
+// takes a lock. The editor calls deliver() every frame, and subscribers hear
+// about each topic once for however many arrived since, and not at all otherwise.
+struct ChangeBus
+{
+    enum Topic
+    {
+        Tuning,       // a new tuning was committed
+        Origin,       // the origin note or its frequency moved
+        StateLoaded,  // everything the menus show may be different
+        Registration, // we're now the MTS-ESP master
+        Visitors,     // another visitor group was chosen, made or deleted
+        Appearance,   // how the lattices are drawn, like low power mode
+        NumTopics
+    };
+
+    struct Subscriber
+    {
+        virtual ~Subscriber() = default;
+        virtual void changed(Topic topic) = 0;
+    };
+
+    // message thread only, these three
+    void subscribe(Topic topic, Subscriber *s) { subscribers[topic].add(s); }
+    void unsubscribe(Subscriber *s)
+    {
+        for (auto &l : subscribers)
+            l.remove(s);
+    }
+
+    void deliver()
+    {
+        auto topics = pending.exchange(0);
+        for (int t = 0; t < NumTopics; ++t)
+        {
+            if (topics & (1u << t))
+            {
+                auto topic = static_cast<Topic>(t);
+                subscribers[t].call([topic](Subscriber &s) { s.changed(topic); });
+            }
+        }
+    }
+
+    void publish(Topic topic)
+    {
+        ++versions[topic];
+        pending.fetch_or(1u << topic);
+    }
+
+    uint64_t version(Topic topic) const { return versions[topic].load(); }
+
+  private:
+    std::array<std::atomic<uint64_t>, NumTopics> versions{};
+    std::atomic<uint32_t> pending{0};
+    std::array<juce::ListenerList<Subscriber>, NumTopics> subscribers;
+};
+} // namespace lattices
+
+#endif // LATTICES_CHANGEBUS_H
@@ -0,0 +1,136 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_GROUPSTRIP_H
+#define LATTICES_GROUPSTRIP_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "GroupThumbnails.h"
+#include "LatticesProcessor.h"
+
+namespace lattices::render
+{
+// A row of visitor group buttons with only as many buttons as fit in it,
+// however many groups there are. Scrolling hands the same buttons other
+// groups rather than making more, so a library of thousands of groups costs
+// the editor no more than a handful does.
+struct GroupStrip : juce::Component
+{
+    // groups from firstGroup on, a button every slotWidth pixels, buttonWidth wide
+    GroupStrip(GroupThumbnails &t, LatticesProcessor &p, int firstGroup, int slotWidth,
+               int buttonWidth)
+        : thumbnails(&t), proc(&p), firstGroup(firstGroup), first(firstGroup),
+          slotWidth(slotWidth), buttonWidth(buttonWidth)
+    {
+    }
+
+    // called with the group whose button was clicked
+    std::function<void(int)> onPick;
+
+    void resized() override
+    {
+        int fit = std::max(getWidth() / slotWidth, 0);
+        while (static_cast<int>(slots.size()) < fit)
+        {
+            int i = static_cast<int>(slots.size());
+            slots.push_back(std::make_unique<GroupButton>(*thumbnails, *proc, first + i));
+            addChildComponent(*slots[i]);
+            slots[i]->setWantsKeyboardFocus(false);
+            slots[i]->onClick = [this, i] {
+                if (onPick)
+                    onPick(slots[i]->getGroup());
+            };
+        }
+        update();
+    }
+
+    void mouseWheelMove(const juce::MouseEvent &, const juce::MouseWheelDetails &wheel) override
+    {
+        // trackpads send lots of little ones, so gather them up into whole steps
+        auto d = std::abs(wheel.deltaX) > std::abs(wheel.deltaY) ? wheel.deltaX : wheel.deltaY;
+        wheelSteps -= d * 4.f;
+        int steps = static_cast<int>(wheelSteps);
+        wheelSteps -= steps;
+        if (steps != 0)
+            scrollBy(steps);
+    }
+
+    // Groups came, went or were renumbered. Also lays the buttons out.
+    void update()
+    {
+        first = std::clamp(first, firstGroup, std::max(firstGroup, numGroups() - fits()));
+
+        int shown = std::clamp(numGroups() - first, 0, fits());
+        for (int i = 0; i < static_cast<int>(slots.size()); ++i)
+        {
+            auto &s = slots[i];
+            if (s->getGroup() != first + i)
+                s->setGroup(first + i);
+            s->setToggleState(first + i == selected, juce::dontSendNotification);
+            s->setBounds(i * slotWidth, 0, buttonWidth, getHeight());
+            s->setVisible(i < shown);
+            s->setEnabled(i < shown && isEnabled());
+        }
+        repaint();
+    }
+
+    // light up group g's button, and scroll to it if it's somewhere else
+    void setSelected(int g)
+    {
+        if (g != selected && g >= firstGroup)
+        {
+            if (g < first)
+                first = g;
+            else if (g >= first + fits())
+                first = g - fits() + 1;
+        }
+        selected = g;
+        update();
+    }
+
+    // a whole strip's worth at a time, for the arrows
+    void page(bool forward) { scrollBy(forward ? fits() : -fits()); }
+
+    bool canScroll(bool forward) const
+    {
+        return forward ? first + fits() < numGroups() : first > firstGroup;
+    }
+
+    void enablementChanged() override { update(); }
+
+  private:
+    GroupThumbnails *thumbnails;
+    LatticesProcessor *proc;
+
+    int firstGroup; // the first one there's ever a button for
+    int first;      // and the first one there is one for now
+    int slotWidth, buttonWidth;
+    int selected{-1};
+    float wheelSteps{0.f};
+
+    std::vector<std::unique_ptr<GroupButton>> slots;
+
+    int numGroups() const { return static_cast<int>(proc->visitorGroups.size()); }
+    int fits() const { return std::max(getWidth() / slotWidth, 1); }
+
+    void scrollBy(int n)
+    {
+        first += n;
+        update();
+    }
+};
+} // namespace lattices::render
+
+#endif // LATTICES_GROUPSTRIP_H
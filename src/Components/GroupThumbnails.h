@@ -0,0 +1,238 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_GROUPTHUMBNAILS_H
+#define LATTICES_GROUPTHUMBNAILS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#include "ScaleData.h"
+#include "LatticeCore.h"
+#include "LatticeTiles.h"
+#include "LatticesProcessor.h"
+
+namespace lattices::render
+{
+// Little pictures of visitor groups, for the buttons that pick them. Each is
+// the group's spheres and lines the way the mini lattice draws them, shrunk to
+// fit and without shadows or ratios. They're drawn the first time they're
+// asked for and then kept by what's in the group, not by which group it is,
+// so looking through the buttons draws nothing but images, and a group only
+// gets drawn again once one of its commas changes.
+struct GroupThumbnails : protected LatticeCore<VisitorCells, Ratios>
+{
+    GroupThumbnails(LatticesProcessor &p, int w, int h) : LatticeCore(p, 8), width(w), height(h)
+    {
+    }
+
+    // the picture of group, drawn for scale real pixels to a component one
+    const juce::Image &get(const lattices::scaledata::ScaleData &group, float scale)
+    {
+        if (scale != pixelScale)
+        {
+            pixelScale = scale;
+            for (auto &t : thumbs)
+                t.valid = false;
+        }
+
+        auto key = contentHash(group);
+        ++uses;
+
+        // the least recently used one goes if we don't have it, there's never many
+        thumb_t *oldest{nullptr};
+        for (auto &t : thumbs)
+        {
+            if (t.valid && t.key == key)
+            {
+                t.lastUsed = uses;
+                return t.image;
+            }
+            if (!oldest || (oldest->valid && !t.valid) ||
+                (oldest->valid == t.valid && t.lastUsed < oldest->lastUsed))
+                oldest = &t;
+        }
+
+        oldest->key = key;
+        oldest->valid = true;
+        oldest->lastUsed = uses;
+        oldest->image = render(group);
+        return oldest->image;
+    }
+
+    // Everything a picture shows: which cells are lit and by which comma
+    static uint64_t contentHash(const lattices::scaledata::ScaleData &group)
+    {
+        uint64_t h{0xCBF29CE484222325ULL};
+        auto mix = [&h](int i) { h = (h ^ static_cast<uint32_t>(i)) * 0x100000001B3ULL; };
+
+        mix(group.numDegrees);
+        for (int d = 0; d < group.numDegrees; ++d)
+        {
+            mix(group.CO[d].first);
+            mix(group.CO[d].second);
+            mix(group.CC[d].nameIndex);
+        }
+        return h;
+    }
+
+  private:
+    struct thumb_t
+    {
+        uint64_t key{0};
+        bool valid{false};
+        uint64_t lastUsed{0};
+        juce::Image image;
+    };
+
+    static constexpr int capacity{64}; // a couple of screenfuls of buttons
+    std::array<thumb_t, capacity> thumbs;
+    uint64_t uses{0};
+
+    int width, height;
+    float pixelScale{0.f};
+
+    std::array<juce::Path, 3> lines;
+    juce::Path stroked;
+
+    juce::Image render(const lattices::scaledata::ScaleData &group)
+    {
+        int n = group.numDegrees;
+        auto &co = group.CO;
+
+        // where each sphere goes in the lattice's pixels, as on the big one
+        float vh = 2.f * JIRadius * (5.f / 3.f);
+        auto at = [&co, vh](int d) {
+            return juce::Point<float>{(co[d].first + co[d].second * .5f) * vh,
+                                      -co[d].second * vh};
+        };
+
+        float x0{at(0).x}, x1{x0}, y0{at(0).y}, y1{y0};
+        int w0{co[0].first}, w1{w0}, v0{co[0].second}, v1{v0};
+        for (int d = 1; d < n; ++d)
+        {
+            auto p = at(d);
+            x0 = std::min(x0, p.x);
+            x1 = std::max(x1, p.x);
+            y0 = std::min(y0, p.y);
+            y1 = std::max(y1, p.y);
+            w0 = std::min(w0, co[d].first);
+            w1 = std::max(w1, co[d].first);
+            v0 = std::min(v0, co[d].second);
+            v1 = std::max(v1, co[d].second);
+        }
+
+        // then all of that, spheres included, fitted in the middle of us
+        float m = ellipseRadius + 2;
+        float k = std::min(width / (x1 - x0 + 2 * m), height / (y1 - y0 + 2 * m));
+
+        auto image = lattices::tiles::TileCache::makeImage(
+            static_cast<int>(std::ceil(width * pixelScale)),
+            static_cast<int>(std::ceil(height * pixelScale)));
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::translation(-(x0 + x1) / 2, -(y0 + y1) / 2)
+                           .scaled(k)
+                           .translated(width / 2.f, height / 2.f)
+                           .scaled(pixelScale));
+
+        field.build(w0 - 1, v0 - 1, w1 + 1, v1 + 1, co.data(), n);
+
+        // lines under the spheres, a pixel wide however small it all gets
+        for (auto &l : lines)
+            l.clear();
+        for (int d = 0; d < n; ++d)
+        {
+            auto [w, v] = co[d];
+            auto p = at(d);
+            if (field.degree(w + 1, v) >= 0)
+            {
+                lines[0].startNewSubPath(p.x, p.y);
+                lines[0].lineTo(p.x + vh, p.y);
+            }
+            if (field.degree(w, v + 1) >= 0)
+            {
+                float ul[2] = {7.f, 3.f};
+                addDashes(lines[1], p.x, p.y, p.x + vh * .5f, p.y - vh, ul);
+            }
+            if (field.degree(w + 1, v - 1) >= 0)
+            {
+                float dl[2] = {2.f, 3.f};
+                addDashes(lines[2], p.x, p.y, p.x + vh * .5f, p.y + vh, dl);
+            }
+        }
+        g.setColour(juce::Colours::ghostwhite.withAlpha(.9f));
+        for (auto &l : lines)
+            strokeInto(g, l, 1.f / k, stroked);
+
+        // and the spheres, coloured by their commas
+        for (int d = 0; d < n; ++d)
+        {
+            auto p = at(d);
+            g.setColour(juce::Colours::black);
+            g.fillEllipse(p.x - ellipseRadius - 1, p.y - JIRadius - 1, 2 * ellipseRadius + 2,
+                          2 * JIRadius + 2);
+
+            auto gradient = Gradients.commaGrad(group.CC[d].nameIndex, p.x);
+            gradient.multiplyOpacity(.75f);
+            g.setGradientFill(gradient);
+            g.fillEllipse(p.x - ellipseRadius, p.y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
+        }
+
+        return image;
+    }
+};
+
+// A visitor group's button, with its number over its picture
+struct GroupButton : juce::TextButton
+{
+    GroupButton(GroupThumbnails &t, LatticesProcessor &p, int g)
+        : juce::TextButton(std::to_string(g)), thumbnails(&t), proc(&p), group(g)
+    {
+    }
+
+    // which group it picks, renumbered when one before it goes
+    void setGroup(int g)
+    {
+        group = g;
+        setButtonText(std::to_string(g));
+    }
+    int getGroup() const { return group; }
+
+    void paintButton(juce::Graphics &g, bool highlighted, bool down) override
+    {
+        auto &lf = getLookAndFeel();
+        auto colour = findColour(getToggleState() ? buttonOnColourId : buttonColourId);
+        lf.drawButtonBackground(g, *this, colour, highlighted, down);
+
+        if (group >= 0 && group < static_cast<int>(proc->visitorGroups.size()))
+        {
+            float scale =
+                juce::jlimit(.25f, 8.f, g.getInternalContext().getPhysicalPixelScaleFactor());
+            auto &image = thumbnails->get(proc->visitorGroups[group], scale);
+            g.setOpacity(isEnabled() ? 1.f : .5f);
+            g.drawImageTransformed(image, juce::AffineTransform::scale(1.f / scale));
+            g.setOpacity(1.f);
+        }
+
+        lf.drawButtonText(g, *this, highlighted, down);
+    }
+
+  private:
+    GroupThumbnails *thumbnails;
+    LatticesProcessor *proc;
+    int group;
+};
+} // namespace lattices::render
+
+#endif // LATTICES_GROUPTHUMBNAILS_H
@@ -0,0 +1,118 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_LABELCACHE_H
+#define LATTICES_LABELCACHE_H
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lattices::labels
+{
+// Laid out note names, by cell and by whatever visitor (if any) is lit there.
+// Whoever owns it clears it when the things every label depends on change,
+// like the origin or the font size. Until then, drawing a label is just
+// drawing glyphs that were already shaped.
+//
+// Tiles are drawn on several threads, so get() can be called from any of
+// them, each with its own slot for laying out, see TileWorkers::numSlots().
+// Nothing is ever taken out mid-frame, so what it hands back stays put until
+// the next trim() or clear(), which only the owner calls between frames.
+struct LabelCache
+{
+    explicit LabelCache(int numSlots = 1) : glyphs(capacity), scratch(numSlots) { clear(); }
+
+    void clear()
+    {
+        used.fill(false);
+        numUsed = 0;
+    }
+
+    // clear out rather than probe forever, the visible cells will be back soon enough
+    void trim()
+    {
+        if (numUsed >= capacity / 2)
+            clear();
+    }
+
+    // The cell's label, laid out by layOut(arrangement) the first time it's
+    // asked for. That's done without holding the lock, so the other workers
+    // only ever wait on a lookup, never on shaping text.
+    template <typename F>
+    const juce::GlyphArrangement &get(int x, int y, int tag, int slot, F &&layOut)
+    {
+        key_t k{x, y, tag};
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto i = find(k);
+            if (used[i])
+                return glyphs[i];
+        }
+
+        auto &fresh = scratch[slot]; // only ever this thread's
+        fresh.clear();
+        layOut(fresh);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto i = find(k);
+        if (used[i]) // another worker got there first, and its label is the same
+            return glyphs[i];
+
+        // too full to take any more this frame, so this one's just for now,
+        // until this slot lays out another
+        if (numUsed >= capacity * 3 / 4)
+            return fresh;
+
+        used[i] = true;
+        keys[i] = k;
+        ++numUsed;
+        std::swap(glyphs[i], fresh); // whatever was there is cleared next time round
+        return glyphs[i];
+    }
+
+  private:
+    struct key_t
+    {
+        int x{0}, y{0}, tag{0};
+        bool operator==(const key_t &) const = default;
+    };
+
+    static constexpr int capacity{4096}; // a power of two, well over a screenful
+    std::array<key_t, capacity> keys{};
+    std::array<bool, capacity> used{};
+    std::vector<juce::GlyphArrangement> glyphs;
+    std::vector<juce::GlyphArrangement> scratch;
+    int numUsed{0};
+    std::mutex mutex;
+
+    // where k is, or the empty slot it would go in
+    int find(const key_t &k) const
+    {
+        auto i = slot(k);
+        while (used[i] && !(keys[i] == k))
+            i = (i + 1) & (capacity - 1);
+        return i;
+    }
+
+    static int slot(const key_t &k)
+    {
+        auto h = static_cast<uint64_t>(static_cast<uint32_t>(k.x)) * 0x9E3779B97F4A7C15ULL;
+        h ^= static_cast<uint64_t>(static_cast<uint32_t>(k.y)) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= static_cast<uint64_t>(static_cast<uint32_t>(k.tag)) * 0x165667B19E3779F9ULL;
+        return static_cast<int>((h >> 32) & (capacity - 1));
+    }
+};
+} // namespace lattices::labels
+
+#endif // LATTICES_LABELCACHE_H
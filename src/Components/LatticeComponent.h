@@ -15,23 +15,38 @@
 #include "JIMath.h"
 #include "ScaleData.h"
 #include "LatticesColours.h"
-#include "LatticesBinary.h"
+#include "LatticeCore.h"
+#include "LatticeGeometry.h"
+#include "GroupThumbnails.h"
+#include "GroupStrip.h"
+#include "LabelCache.h"
+#include "LatticeTiles.h"
 #include "LatticesProcessor.h"
+#include "AllocationCounter.h"
 
 #include <algorithm>
 #include <numeric>
 #include <array>
 #include <cmath>
 #include <climits>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 
 #include <juce_animation/juce_animation.h>
 #include <melatonin_blur/melatonin_blur.h>
 
 //==============================================================================
-struct LatticeComponent : juce::Component, private juce::MultiTimer
+struct LatticeComponent
+    : juce::Component,
+      protected lattices::render::LatticeCore<lattices::render::ScaleCells,
+                                              lattices::render::NoteNames>,
+      private juce::MultiTimer,
+      private lattices::ChangeBus::Subscriber
 {
-    LatticeComponent(LatticesProcessor &p) : proc(&p), Gradients(JIRadius)
+    LatticeComponent(LatticesProcessor &p) : LatticeCore(p, 26)
     {
         auto gwc = juce::Colours::ghostwhite;
 
@@ -64,52 +79,135 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
         zoomInButton->onClick = [this] { zoomIn(); };
         zoomInButton->setWantsKeyboardFocus(false);
 
-        for (int i = 0; i < 32; ++i)
-        {
-            visButtons.emplace_back(std::make_unique<juce::TextButton>(std::to_string(i + 1)));
-            addAndMakeVisible(*visButtons[i]);
-            visButtons[i]->setClickingTogglesState(true);
-            visButtons[i]->onClick = [this, i] { proc->selectVisitorGroup(i + 1, true); };
-            visButtons[i]->setWantsKeyboardFocus(false);
-        }
+        // group 0 is nobody visiting, which is what clicking the lit one again gets you
+        visButtons = std::make_unique<lattices::render::GroupStrip>(thumbnails, p, 1, 40, 35);
+        addAndMakeVisible(*visButtons);
+        visButtons->onPick = [this](int g) { proc->selectVisitorGroup(g, true); };
 
-        updater.addAnimator(follow);
         setWantsKeyboardFocus(true);
-        startTimer(0, 50); // for keyboard gestures
-        startTimer(1, 50); // for following the highlight around
+        // for following the highlight around
+        proc->changes.subscribe(lattices::ChangeBus::Tuning, this);
+        // and for which group buttons there are
+        proc->changes.subscribe(lattices::ChangeBus::Visitors, this);
+        proc->changes.subscribe(lattices::ChangeBus::StateLoaded, this);
+        proc->changes.subscribe(lattices::ChangeBus::Appearance, this);
+        lowPower = proc->lowPower;
+        updateControls();
         repaint();
     }
 
-    LatticeComponent(LatticesProcessor &p, bool smol) : proc(&p), Gradients(JIRadius) {}
+    ~LatticeComponent()
+    {
+        proc->changes.unsubscribe(this);
+        proc = nullptr;
+    }
 
-    ~LatticeComponent() { proc = nullptr; }
+    // a step on the buttons is about a radius either way, as it always was
+    void zoomIn() { zoomAbout((JIRadius * viewZoom + 1) / (JIRadius * viewZoom), centre()); }
+    void zoomOut() { zoomAbout((JIRadius * viewZoom - 1) / (JIRadius * viewZoom), centre()); }
 
-    void zoomIn()
+    void mouseWheelMove(const juce::MouseEvent &e, const juce::MouseWheelDetails &wheel) override
     {
-        if (JIRadius == 42)
-            return;
+        zoomAbout(std::pow(2.f, wheel.deltaY), e.position);
+        hover(cellUnder(e.position));
+    }
+
+    void mouseMagnify(const juce::MouseEvent &e, float scaleFactor) override
+    {
+        zoomAbout(scaleFactor, e.position);
+    }
 
-        ++JIRadius;
-        ellipseRadius = JIRadius * 1.15;
-        stoke.setPointHeight(JIRadius);
-        blackShadow.setRadius(JIRadius / 3);
-        whiteShadow.setRadius(JIRadius / 2);
-        Gradients.setSize(JIRadius);
+    // dragging the lattice about, which stops it following the highlight for now
+    void mouseDown(const juce::MouseEvent &) override
+    {
+        panning = true;
+        follow.complete();
+        panFromX = xShift;
+        panFromY = yShift;
+    }
+
+    void mouseDrag(const juce::MouseEvent &e) override
+    {
+        auto d = e.getOffsetFromDragStart();
+        xShift = panFromX - d.x / viewZoom;
+        yShift = panFromY + d.y / viewZoom;
         repaint();
     }
 
-    void zoomOut()
+    // a click that didn't drag takes the scale's root straight to that sphere,
+    // except in Syntonic mode where it can't get to just any of them
+    void mouseUp(const juce::MouseEvent &e) override
     {
-        if (JIRadius == 15)
+        panning = false;
+        if (e.mouseWasDraggedSinceMouseDown())
             return;
 
-        --JIRadius;
-        ellipseRadius = JIRadius * 1.15;
-        stoke.setPointHeight(JIRadius);
-        blackShadow.setRadius(JIRadius / 3);
-        whiteShadow.setRadius(JIRadius / 2);
-        Gradients.setSize(JIRadius);
-        repaint();
+        if (auto cell = cellUnder(e.position))
+            proc->jumpTo(cell->first, cell->second);
+    }
+
+    void mouseMove(const juce::MouseEvent &e) override { hover(cellUnder(e.position)); }
+    void mouseExit(const juce::MouseEvent &) override { hover(std::nullopt); }
+
+    // what the sphere at (w, v) is, exactly, in cents and in Hz
+    juce::String describe(int w, int v)
+    {
+        auto [n, d] = calculateCell(w, v);
+
+        // a visitor moves it by its comma, the same as its name
+        int degree = proc->activeCells.find({w, v, proc->activePlane});
+        bool visited = proc->mode != LatticesProcessor::Syntonic && degree >= 0 &&
+                       proc->currentVisitors->CC[degree].nameIndex > 1;
+        if (visited)
+            reCalculateCell(n, d, degree);
+
+        // and off the plane, by however many steps of the higher primes
+        lattices::scaledata::coordN_t plane{w, v, proc->activePlane};
+        for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+        {
+            auto &axis = lattices::scaledata::extraAxes[a];
+            for (int steps = plane.axis(a); steps > 0; --steps)
+            {
+                n *= axis.num;
+                d *= axis.den;
+            }
+            for (int steps = plane.axis(a); steps < 0; ++steps)
+            {
+                n *= axis.den;
+                d *= axis.num;
+            }
+        }
+        proc->jim.octaveReduceRatio(n, d);
+        auto gcd = std::gcd(n, d);
+        n /= gcd;
+        d /= gcd;
+
+        // That's which note it is. What it sounds like is, if it's lit, what
+        // the processor tunes it to, and otherwise where it would sound in
+        // the root's period. Cents are from the origin note, whatever the period.
+        double hz;
+        if (degree >= 0)
+        {
+            hz = degreeHz(degree);
+        }
+        else
+        {
+            auto root = proc->coOrds[0];
+            auto [rn, rd] = calculateCell(w - root.first, v - root.second);
+            hz = degreeHz(0) * rn / rd;
+        }
+        double cents = 1200.0 * std::log2(hz / proc->originalRefFreq);
+
+        return juce::String(std::to_string(n) + "/" + std::to_string(d)) + "   " +
+               juce::String(cents, 2) + " cents from 1/1   " + juce::String(hz, 2) + " Hz";
+    }
+
+    // the lit degree d's frequency, the same sum updateTuning() does
+    double degreeHz(int d) const
+    {
+        if (proc->mode == LatticesProcessor::Syntonic)
+            return proc->originalRefFreq * proc->syntonicGroup.getTuning(d);
+        return proc->originalRefFreq * proc->ratioToOriginal * proc->currentVisitors->CT[d];
     }
 
     void resized() override
@@ -122,10 +220,8 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
         arrowButtons[2]->setBounds(b.getRight() - 71, b.getBottom() - 104, 24, 24);
         arrowButtons[3]->setBounds(b.getRight() - 71, b.getBottom() - 38, 24, 24);
 
-        for (int i = 0; i < visButtons.size(); ++i)
-        {
-            visButtons[i]->setBounds(10 + i * 40, b.getBottom() - 45, 35, 35);
-        }
+        // along the bottom, up to the navigation buttons
+        visButtons->setBounds(10, b.getBottom() - 45, std::max(b.getWidth() - 124, 0), 35);
 
         zoomOutButton->setBounds(b.getRight() - 90, 45, 35, 35);
         zoomInButton->setBounds(b.getRight() - 50, 45, 35, 35);
@@ -136,39 +232,74 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
         if (key == juce::KeyPress::returnKey && !homeFlag)
         {
             homeFlag = true;
+            holdKeys();
             proc->shift(0);
             return true;
         }
         if (key == juce::KeyPress::leftKey && !westFlag)
         {
             westFlag = true;
+            holdKeys();
             proc->shift(1);
             return true;
         }
         if (key == juce::KeyPress::rightKey && !eastFlag)
         {
             eastFlag = true;
+            holdKeys();
             proc->shift(2);
             return true;
         }
         if (key == juce::KeyPress::upKey && !northFlag)
         {
             northFlag = true;
+            holdKeys();
             proc->shift(3);
             return true;
         }
         if (key == juce::KeyPress::downKey && !southFlag)
         {
             southFlag = true;
+            holdKeys();
             proc->shift(4);
             return true;
         }
+        if (key == juce::KeyPress::pageUpKey && !septimalUpFlag)
+        {
+            septimalUpFlag = true;
+            holdKeys();
+            proc->shift(5);
+            return true;
+        }
+        if (key == juce::KeyPress::pageDownKey && !septimalDownFlag)
+        {
+            septimalDownFlag = true;
+            holdKeys();
+            proc->shift(6);
+            return true;
+        }
+        // Home and End step along the 11 axis, as Page Up and Down do the 7 one
+        if (key == juce::KeyPress::homeKey && !undecimalUpFlag)
+        {
+            undecimalUpFlag = true;
+            holdKeys();
+            proc->shift(7);
+            return true;
+        }
+        if (key == juce::KeyPress::endKey && !undecimalDownFlag)
+        {
+            undecimalDownFlag = true;
+            holdKeys();
+            proc->shift(8);
+            return true;
+        }
 
         auto k = std::to_wstring(key.getTextCharacter());
         auto n = std::stoi(k) - 48;
         if (n >= 0 && n <= 9 && !visitorFlag)
         {
             visitorFlag = true;
+            holdKeys();
             if (n == 0)
                 n += 10;
             proc->selectVisitorGroup(n, true);
@@ -180,46 +311,314 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
 
     void timerCallback(int timerID) override
     {
+        if (timerID == 1)
+        {
+            stopTimer(1);
+            settleZoom();
+        }
+
+        if (timerID == 2)
+        {
+            stopTimer(2);
+            updater.reset();
+        }
+
         if (timerID == 0)
         {
+            stopTimer(0);
             homeFlag = false;
             westFlag = false;
             eastFlag = false;
             northFlag = false;
             southFlag = false;
+            septimalUpFlag = false;
+            septimalDownFlag = false;
+            undecimalUpFlag = false;
+            undecimalDownFlag = false;
             visitorFlag = false;
         }
+    }
 
-        if (timerID == 1)
+    void changed(lattices::ChangeBus::Topic topic) override
+    {
+        if (topic == lattices::ChangeBus::Visitors || topic == lattices::ChangeBus::StateLoaded)
         {
-            if (proc->changed)
+            updateControls();
+            return;
+        }
+
+        if (topic == lattices::ChangeBus::Appearance)
+        {
+            if (lowPower != proc->lowPower)
             {
-                repaint();
-                proc->changed = false;
+                lowPower = proc->lowPower;
+                invalidateTiles();
+            }
+            return;
+        }
 
-                int nx = proc->positionXY.first;
-                int ny = proc->positionXY.second;
+        // several may have come and gone since we last heard, it's the newest we want
+        auto version = proc->changes.version(lattices::ChangeBus::Tuning);
+        if (version == seenTuning)
+            return;
+        seenTuning = version;
 
-                bool sH = (goalX != nx && nx % 4 == 0);
-                bool sV = (goalY != ny && ny % 3 == 0);
+        fieldStale = true;
+        repaint();
+        if (hovered)
+            hover(hovered, true); // it may sound different now
 
-                procX = nx;
-                procY = ny;
+        int nx = proc->positionXY.first;
+        int ny = proc->positionXY.second;
 
-                if (sH || sV)
-                {
-                    priorX = xShift;
-                    priorY = yShift;
-                    goalX = procX;
-                    goalY = procY;
+        bool sH = (goalX != nx && nx % 4 == 0);
+        bool sV = (goalY != ny && ny % 3 == 0);
 
-                    follow.start();
-                }
-            }
+        procX = nx;
+        procY = ny;
+
+        if (sH || sV)
+        {
+            priorX = xShift;
+            priorY = yShift;
+            goalX = procX;
+            goalY = procY;
+
+            if (lowPower)
+                shiftToFollow(1.f); // straight there
+            else
+                startFollowing();
         }
     }
 
     void paint(juce::Graphics &g) override
+    {
+        lattices::allocations::FrameCounter frame{"Lattice paint"};
+        if (getWidth() <= 0 || getHeight() <= 0)
+            return;
+
+        drawTiles(g);
+
+        // With a menu open, the same lattice only dimmer. The tiles don't
+        // change, so opening and closing one doesn't draw anything over.
+        if (!this->isEnabled())
+        {
+            g.fillAll(lattices::colours::background.withAlpha(disabledDim));
+        }
+        else
+        {
+            auto b = this->getLocalBounds();
+
+            g.setColour(lattices::colours::background);
+            g.fillRect(b.getRight() - 110, b.getBottom() - 110, 101, 101);
+            g.setColour(juce::Colours::ghostwhite);
+            g.drawRect(b.getRight() - 110, b.getBottom() - 110, 101, 101);
+
+            if (hoverText.isNotEmpty())
+            {
+                auto r = readoutArea();
+                g.setColour(lattices::colours::background);
+                g.fillRect(r);
+                g.setColour(juce::Colours::ghostwhite);
+                g.drawRect(r);
+                g.setFont(readoutFont);
+                g.drawText(hoverText, r.reduced(6, 0), juce::Justification::centredLeft);
+            }
+        }
+    }
+
+  protected:
+    bool fieldStale{true};
+
+    // Every name depends on these, so if any of them change they all have to go
+    struct label_context_t
+    {
+        std::pair<uint8_t, int> origin{};
+        uint64_t plane{0};
+        int radius{0};
+        std::array<uint64_t, 4> generators{};
+        bool operator==(const label_context_t &) const = default;
+    };
+    label_context_t labelContext{};
+    lattices::labels::LabelCache labels{lattices::tiles::TileWorkers::numSlots()};
+
+    // There are only so many ways a sphere can look: the root, each row's colour,
+    // or a comma's, times how bright it is, and whether it's drawn in full or
+    // flat. So each one is drawn (and blurred) once per zoom level the first
+    // time it's needed, then just stamped down.
+    enum SphereLooks
+    {
+        rootLook = 0,
+        rowLook = 1,
+        commaLook = 4,
+        numLooks = commaLook + lattices::scaledata::maxCommas
+    };
+    static constexpr int alphaSteps{32};
+    std::array<juce::Image, 2 * numLooks * (alphaSteps + 1)> sphereSprites;
+
+    void clearSprites()
+    {
+        for (auto &s : sphereSprites)
+            s = juce::Image{};
+    }
+
+    std::mutex spriteMutex; // tiles ask for them from several threads
+
+    const juce::Image &sphereSprite(int look, float alpha, bool flat = false)
+    {
+        std::lock_guard<std::mutex> lock(spriteMutex);
+        int step = juce::jlimit(0, alphaSteps, juce::roundToInt(alpha * alphaSteps));
+        auto &sprite = sphereSprites[(flat * numLooks + look) * (alphaSteps + 1) + step];
+        if (sprite.isValid())
+            return sprite;
+
+        // room for the widest shadow all round, in real pixels like the tiles
+        int margin = JIRadius / 2 + JIRadius / 10 + 2;
+        sprite = makeSprite(margin, tiles.scale(), [&](juce::Graphics &sG, float x, float y) {
+            auto a = static_cast<float>(step) / alphaSteps;
+            if (!flat)
+            {
+                drawSphere(sG, x, y, sphereGradient(look, x), a);
+                return;
+            }
+
+            // a plain disc will do, nobody's going to miss its shadow
+            auto gradient = sphereGradient(look, x);
+            gradient.multiplyOpacity(a);
+            sG.setGradientFill(gradient);
+            sG.fillEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
+        });
+        return sprite;
+    }
+
+    juce::ColourGradient sphereGradient(int look, float x)
+    {
+        if (look == rootLook)
+            return Gradients.rootGrad(x);
+        if (look >= commaLook)
+            return Gradients.commaGrad(look - commaLook, x);
+        return Gradients.latticeGrad(look - rowLook, x);
+    }
+
+    // Every line is one of three styles at one of the spheres' brightness
+    // steps. A tile gathers its lines into a path for each, and then strokes
+    // each path once, rather than every line on its own.
+    enum LineStyles
+    {
+        solidLine = 0,
+        upLine = 1,
+        downLine = 2,
+        numLineStyles = 3
+    };
+
+    struct line_batch_t
+    {
+        std::array<juce::Path, numLineStyles * (alphaSteps + 1)> paths;
+        std::array<bool, numLineStyles * (alphaSteps + 1)> used{};
+
+        void clear()
+        {
+            for (int i = 0; i < paths.size(); ++i)
+            {
+                if (used[i])
+                    paths[i].clear();
+                used[i] = false;
+            }
+        }
+
+        juce::Path &path(int style, float alpha)
+        {
+            int step = juce::jlimit(0, alphaSteps, juce::roundToInt(alpha * alphaSteps));
+            int i = style * (alphaSteps + 1) + step;
+            used[i] = true;
+            return paths[i];
+        }
+
+        void stroke(juce::Graphics &g, float thickness)
+        {
+            for (int i = 0; i < paths.size(); ++i)
+            {
+                if (!used[i])
+                    continue;
+
+                float alpha = static_cast<float>(i % (alphaSteps + 1)) / alphaSteps;
+                g.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
+                strokeInto(g, paths[i], thickness, stroked);
+            }
+        }
+
+        juce::Path stroked;
+    };
+
+    // Low power mode draws every sphere flat, so nothing gets blurred, and
+    // jumps to follow the highlight instead of easing after it. The tiles
+    // are drawn on other threads, so they go by this copy of it.
+    bool lowPower{false};
+
+    // Spheres further than this from a lit one are drawn flat and without a
+    // name. Zoomed out, that's everything but the lit ones and their
+    // neighbours, so however big the window gets there's only so much detail.
+    static constexpr int detailRadius{20};
+    int detailDistance() const { return (JIRadius < detailRadius) ? 1 : 4; }
+
+    void drawSphere(juce::Graphics &sG, float x, float y, juce::ColourGradient gradient,
+                    float alpha)
+    {
+        int shadowSpacing1 = JIRadius / 20;
+        int shadowSpacing2 = JIRadius / 10;
+        float thickness = JIRadius / 9.f;
+
+        // Spheres
+        juce::Path e{};
+        e.addEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
+        // And their shadows
+        juce::Path b{};
+        b.addEllipse(x - ellipseRadius - shadowSpacing1, y - JIRadius - shadowSpacing1,
+                     2 * ellipseRadius + shadowSpacing2, 2 * JIRadius + shadowSpacing2);
+
+        whiteShadow.setOpacity(alpha);
+        whiteShadow.render(sG, e);
+        blackShadow.setOpacity(alpha);
+        blackShadow.render(sG, b);
+        sG.setColour(juce::Colours::black);
+        sG.fillPath(b);
+        gradient.multiplyOpacity(alpha);
+        sG.setGradientFill(gradient);
+        sG.fillPath(e);
+        sG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
+        sG.drawEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius,
+                       thickness);
+    }
+
+    // The lattice is drawn onto tiles that persist between paints, see LatticeTiles.h.
+    // When the tuning changes only the tiles with a cell that looks different
+    // get drawn again, and repaints from scrolling, hovering buttons or from
+    // menus on top mostly just composite them.
+    lattices::tiles::TileCache tiles;
+    lattices::tiles::TileWorkers workers;
+    std::vector<lattices::tiles::TileCache::tile_t *> visibleTiles, dirtyTiles;
+    std::vector<line_batch_t> lineBatches{
+        static_cast<size_t>(lattices::tiles::TileWorkers::numSlots())};
+    std::function<void(int, int)> drawDirtyTile{[this](int i, int slot)
+                                                { drawTile(*dirtyTiles[i], slot); }};
+    int tuningVersion{0};
+
+    void invalidateTiles()
+    {
+        tiles.invalidate();
+        repaint();
+    }
+
+    static constexpr float disabledDim{.6f};
+
+    void enablementChanged() override
+    {
+        updateControls();
+        repaint();
+    }
+
+    // Which buttons are shown and which are pressed, kept out of paint()
+    void updateControls()
     {
         bool enabled = this->isEnabled();
 
@@ -234,194 +633,309 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
         zoomInButton->setVisible(enabled);
         zoomOutButton->setEnabled(enabled);
         zoomOutButton->setVisible(enabled);
-        if (enabled)
+
+        visButtons->setEnabled(enabled);
+        visButtons->setVisible(enabled);
+        visButtons->setSelected(proc->getCurrentVisitorGroupIndex());
+    }
+
+    // What a cell needs to be drawn
+    struct cell_t
+    {
+        int degree{0}, degreeTransposed{0}, vis{0};
+        int dist{0}, hDist{0}, uDist{0}, dDist{0};
+        int tag{0};                                // which name it has, see LabelCache.h
+    };
+
+    cell_t cellAt(int w, int v)
+    {
+        cell_t c{};
+        c.degree = proc->latticeLayout.degreeAt(w, v);
+
+        // get our bearings so we know how brightly to draw stuff
+        auto &cc = proc->currentVisitors->CC;
+
+        int dC = field.degree(w, v);         // current sphere
+        int dH = field.degree(w + 1, v);     // next one over
+        int dU = field.degree(w, v + 1);     // next one up
+        int dD = field.degree(w + 1, v - 1); // next one down
+
+        int hVis{0}, uVis{0}, dVis{0};
+        if (dC >= 0)
         {
-            int cv = proc->getCurrentVisitorGroupIndex();
-            int idx{1};
-            int nv = static_cast<int>(proc->visitorGroups.size());
-            for (const auto &v : visButtons)
-            {
-                v->setToggleState(idx == cv, juce::dontSendNotification);
-                v->setEnabled(idx < nv);
-                v->setVisible(idx < nv);
-                idx++;
-            }
+            c.degreeTransposed = dC;
+            c.vis = cc[dC].nameIndex;
         }
-        else
+        hVis = (dH >= 0) ? cc[dH].nameIndex : 0;
+        uVis = (dU >= 0) ? cc[dU].nameIndex : 0;
+        dVis = (dD >= 0) ? cc[dD].nameIndex : 0;
+        // ok, so how far is this sphere from a lit up one?
+        c.dist = field.distance(w, v);
+        // and what about its neighbors?
+        c.hDist = std::max(c.dist, field.distance(w + 1, v));
+        c.uDist = std::max(c.dist, field.distance(w, v + 1));
+        c.dDist = std::max(c.dist, field.distance(w + 1, v - 1));
+
+        // If NOT (this sphere and its neighbor are both normal,
+        // or they have the same visitor).
+        // In other words: If one of these has a visitor from
+        // some dimension, and the other does not.
+        // We will then draw the lines dimmer to emphasize the disconnect.
+        int vis = c.vis;
+        if (!((vis < 2 && hVis < 2) || vis == hVis))
+        {
+            c.hDist += 5;
+        }
+        if (!((vis < 2 && uVis < 2) || vis == uVis))
         {
-            for (const auto &v : visButtons)
+            c.uDist += 5;
+        }
+        if (!((vis < 2 && dVis < 2) || vis == dVis))
+        {
+            c.dDist += 5;
+        }
+
+        // a lit visitor changes the name, so it's part of what we look it up by
+        if (c.dist == 0 && vis > 1)
+        {
+            bool major = proc->currentVisitors->layout().major[c.degreeTransposed];
+            c.tag = 1 + vis * 2 + major;
+        }
+        return c;
+    }
+
+    // Everything about a cell that changes how it's drawn, once the names and
+    // the zoom level are settled. Distances that far out all look the same.
+    static uint64_t signature(const cell_t &c)
+    {
+        auto d = [](int dist) { return static_cast<uint64_t>(std::min(dist, 4095)); };
+        return d(c.dist) | d(c.hDist) << 12 | d(c.uDist) << 24 | d(c.dDist) << 36 |
+               static_cast<uint64_t>(c.tag) << 48 | static_cast<uint64_t>(c.degree == 0) << 63;
+    }
+
+    // The cells drawing anything in [x0, x1] x [y0, y1], in the lattice's own
+    // pixels, where cell (w, v) sits at ((w + v / 2) * vh, -v * vh).
+    struct cell_range_t
+    {
+        float x0, x1, vh;
+        int vMin, vMax;
+
+        int wFrom(int v) const { return static_cast<int>(std::ceil(x0 / vh - v * .5f)); }
+        int wTo(int v) const { return static_cast<int>(std::floor(x1 / vh - v * .5f)); }
+    };
+
+    cell_range_t cellsIn(float x0, float y0, float x1, float y1) const
+    {
+        float vh = 2.f * JIRadius * (5.f / 3.f);
+        // lines reach a whole step over, further than any sphere's shadow
+        float m = vh + 2;
+        x0 -= m;
+        y0 -= m;
+        x1 += m;
+        y1 += m;
+        return {x0, x1, vh, static_cast<int>(std::ceil(-y1 / vh)),
+                static_cast<int>(std::floor(-y0 / vh))};
+    }
+
+    // The sphere at p, if there's one there, see LatticeGeometry.h
+    std::optional<std::pair<int, int>> cellUnder(juce::Point<float> p) const
+    {
+        float vh = 2.f * JIRadius * (5.f / 3.f);
+        lattices::geometry::view_t view{static_cast<float>(getWidth()),
+                                        static_cast<float>(getHeight()), xShift, yShift,
+                                        viewZoom};
+        auto [x, y] = view.toLattice(p.x, p.y);
+        return lattices::geometry::cellAt(x, y, vh, ellipseRadius, JIRadius);
+    }
+
+    void drawTiles(juce::Graphics &g)
+    {
+        constexpr int size = lattices::tiles::TileCache::tileSize;
+
+        // Scaled up by the editor or the display, the tiles are drawn bigger
+        // instead of being stretched, so it's only ever one pixel to one
+        float scale = juce::jlimit(.25f, 8.f, g.getInternalContext().getPhysicalPixelScaleFactor());
+        if (scale != tiles.scale())
+        {
+            tiles.setScale(scale);
+            clearSprites();
+        }
+
+        // Where the lattice's origin lands on us, how far we go and how big a
+        // tile looks, in real pixels. Mid zoom the tiles get stretched to
+        // fit, the rest of the time they go down on whole pixels.
+        float z = viewZoom;
+        float ox = (getWidth() / 2.f - xShift * z) * scale;
+        float oy = (getHeight() / 2.f + yShift * z) * scale;
+        if (z == 1.f)
+        {
+            ox = std::round(ox);
+            oy = std::round(oy);
+        }
+        float pw = getWidth() * scale, ph = getHeight() * scale;
+        float ts = size * z;
+
+        auto first = [ts](float o) { return static_cast<int>(std::floor(-o / ts)); };
+        auto last = [ts](float o, float p) {
+            return static_cast<int>(std::ceil((p - o) / ts)) - 1;
+        };
+        int tx0 = first(ox), tx1 = last(ox, pw);
+        int ty0 = first(oy), ty1 = last(oy, ph);
+
+        float s = size / scale;
+        auto r = cellsIn(tx0 * s, ty0 * s, (tx1 + 1) * s, (ty1 + 1) * s);
+        int x0 = r.wFrom(r.vMax), x1 = r.wTo(r.vMin) + 1, y0 = r.vMin - 1, y1 = r.vMax + 1;
+        if (fieldStale || !field.covers(x0, y0, x1, y1))
+        {
+            // a little extra so following the highlight doesn't rebuild every frame
+            int pad = 4;
+            buildField(x0 - pad, y0 - pad, x1 + pad, y1 + pad);
+            if (fieldStale)
+                ++tuningVersion;
+            fieldStale = false;
+        }
+
+        auto &jim = proc->jim;
+        label_context_t context{proc->originNoteName, proc->activePlane, JIRadius,
+                                {jim.horizNum, jim.horizDen, jim.diagNum, jim.diagDen}};
+        if (!(context == labelContext))
+        {
+            labels.clear();
+            tiles.invalidate();
+            labelContext = context;
+        }
+
+        labels.trim();
+
+        // find the ones that need drawing
+        tiles.reserve(2 * (tx1 - tx0 + 1) * (ty1 - ty0 + 1));
+        tiles.nextFrame();
+        visibleTiles.clear();
+        dirtyTiles.clear();
+        for (int ty = ty0; ty <= ty1; ++ty)
+        {
+            for (int tx = tx0; tx <= tx1; ++tx)
             {
-                v->setEnabled(false);
-                v->setVisible(false);
+                auto &t = tiles.get(tx, ty);
+                if (!t.valid || t.version != tuningVersion)
+                {
+                    auto sig = tileSignature(tx, ty);
+                    if (!t.valid || sig != t.signature)
+                        dirtyTiles.push_back(&t);
+                    t.valid = true;
+                    t.signature = sig;
+                    t.version = tuningVersion;
+                }
+                visibleTiles.push_back(&t);
             }
         }
 
-        int shadowSpacing1 = JIRadius / 20;
-        int shadowSpacing2 = JIRadius / 10;
+        // draw them all at once
+        workers.run(static_cast<int>(dirtyTiles.size()), drawDirtyTile);
 
-        float ctrDistance{JIRadius * (5.f / 3.f)};
+        for (auto *t : visibleTiles)
+        {
+            auto at = juce::AffineTransform::scale(z).translated(t->x * ts + ox, t->y * ts + oy);
+            g.drawImageTransformed(t->image, at.scaled(1.f / scale), false);
+        }
+    }
 
-        float vhDistance = 2.0f * ctrDistance;
+    uint64_t tileSignature(int tx, int ty)
+    {
+        float size = lattices::tiles::TileCache::tileSize / tiles.scale();
+        auto r = cellsIn(tx * size, ty * size, (tx + 1) * size, (ty + 1) * size);
 
-        auto ctrX = getWidth() / 2;
-        auto ctrH = getHeight() / 2;
+        uint64_t h{0xCBF29CE484222325ULL};
+        for (int v = r.vMin; v <= r.vMax; ++v)
+        {
+            for (int w = r.wFrom(v); w <= r.wTo(v); ++w)
+            {
+                h = (h ^ signature(cellAt(w, v))) * 0x100000001B3ULL;
+            }
+        }
+        return h;
+    }
 
-        int yS = static_cast<int>(std::abs(yShift));
-        int xS = static_cast<int>(std::abs(xShift));
+    // All the lines, then all the spheres on top, then all their names on top
+    // of those, for every cell reaching into this tile.
+    void drawTile(lattices::tiles::TileCache::tile_t &tile, int slot)
+    {
+        float scale = tiles.scale();
+        float size = lattices::tiles::TileCache::tileSize / scale;
+        float tileX = tile.x * size, tileY = tile.y * size;
+        auto r = cellsIn(tileX, tileY, tileX + size, tileY + size);
+        float vhDistance = r.vh;
+        float thickness = JIRadius / 9.f;
+        int detail = detailDistance();
 
-        int nV = std::ceil(getHeight() / vhDistance) + yS;
-        int nW = std::ceil(getWidth() / vhDistance) + xS;
+        tile.image.clear(tile.image.getBounds());
+        juce::Graphics tG(tile.image);
+        tG.addTransform(juce::AffineTransform::scale(scale));
 
-        int dist{0}, hDist{0}, uDist{0}, dDist{0};
-        float thickness = JIRadius / 9.f;
-        float alpha{0.f};
+        // one per slot, so the paths' storage gets reused from tile to tile
+        auto &lines = lineBatches[slot];
+        lines.clear();
 
-        juce::Image Lines{juce::Image::ARGB, getWidth(), getHeight(), true};
-        juce::Image Spheres{juce::Image::ARGB, getWidth(), getHeight(), true};
-        juce::Image Text{juce::Image::ARGB, getWidth(), getHeight(), true};
+        for (int pass = 0; pass < 3; ++pass)
         {
-            juce::Graphics lG(Lines);
-            juce::Graphics sG(Spheres);
-            juce::Graphics tG(Text);
-            for (int v = -nV; v < nV; ++v)
-            {
-                float off = v * vhDistance * 0.5f;
-                float y = -v * vhDistance + ctrH + yShift;
-                if (y < -ctrDistance || y > getHeight() + ctrDistance)
-                    continue;
+            if (pass == 1)
+                lines.stroke(tG, thickness);
 
-                for (int w = -nW; w < nW; ++w)
+            for (int v = r.vMin; v <= r.vMax; ++v)
+            {
+                for (int w = r.wFrom(v); w <= r.wTo(v); ++w)
                 {
-                    float x = w * vhDistance + ctrX + off - xShift;
+                    float x = (w + v * .5f) * vhDistance - tileX;
+                    float y = -v * vhDistance - tileY;
+                    auto c = cellAt(w, v);
+                    float alpha{0.f};
 
-                    if (x < -ctrDistance || x > getWidth() + ctrDistance)
+                    if (pass == 0)
+                    {
+                        // Horizontal Line
+                        alpha = 1.f / (std::sqrt(c.hDist) + 1);
+                        auto &horiz = lines.path(solidLine, alpha);
+                        horiz.startNewSubPath(x, y);
+                        horiz.lineTo(x + vhDistance, y);
+
+                        // Upward Line
+                        alpha = 1.f / (std::sqrt(c.uDist) + 1);
+                        float ul[2] = {7.f, 3.f};
+                        addDashes(lines.path(upLine, alpha), x, y, x + (vhDistance * .5f),
+                                  y - vhDistance, ul);
+
+                        // Downward Line
+                        alpha = 1.f / (std::sqrt(c.dDist) + 1);
+                        float dl[2] = {2.f, 3.f};
+                        addDashes(lines.path(downLine, alpha), x, y, x + (vhDistance * .5f),
+                                  y + vhDistance, dl);
                         continue;
+                    }
 
-                    int degree = ((7 * w + 4 * v) % 12 + 12) % 12;
-                    int degreeTransposed{0};
-                    int vis{0}, hVis{0}, uVis{0}, dVis{0};
-                    if (enabled) // get our bearings so we know how brightly to draw stuff
-                    {
-                        std::pair<int, int> C = {w, v};         // current sphere
-                        std::pair<int, int> H = {w + 1, v};     // next one over
-                        std::pair<int, int> U = {w, v + 1};     // next one up
-                        std::pair<int, int> D = {w + 1, v - 1}; // next one down
+                    alpha = 1.f / (std::sqrt(c.dist) + 1);
 
-                        for (int d = 0; d < 12; ++d)
-                        {
-                            auto dco = proc->coOrds[d];
-                            if (C == dco)
-                            {
-                                degreeTransposed = d;
-                                vis = proc->currentVisitors->CC[d].nameIndex;
-                                continue;
-                            }
-                            if (H == dco)
-                            {
-                                hVis = proc->currentVisitors->CC[d].nameIndex;
-                                continue;
-                            }
-                            if (U == dco)
-                            {
-                                uVis = proc->currentVisitors->CC[d].nameIndex;
-                                continue;
-                            }
-                            if (D == dco)
-                            {
-                                dVis = proc->currentVisitors->CC[d].nameIndex;
-                            }
-                        }
-                        // ok, so how far is this sphere from a lit up one?
-                        dist = calcDist(C);
-                        // and what about its neighbors?
-                        hDist = std::max(dist, calcDist(H));
-                        uDist = std::max(dist, calcDist(U));
-                        dDist = std::max(dist, calcDist(D));
-
-                        // If NOT (this sphere and its neighbor are both normal,
-                        // or they have the same visitor).
-                        // In other words: If one of these has a visitor from
-                        // some dimension, and the other does not.
-                        // We will then draw the lines dimmer to emphasize the disconnect.
-                        if (!((vis < 2 && hVis < 2) || vis == hVis))
-                        {
-                            hDist += 5;
-                        }
-                        if (!((vis < 2 && uVis < 2) || vis == uVis))
+                    if (pass == 1)
+                    {
+                        // Select gradient colour, by way of which sprite to stamp
+                        int look{rowLook + std::abs(v % 3)};
+                        bool rcs = (c.vis > 1 && c.vis < proc->commaRegistry.size);
+                        if (c.degree == 0)
                         {
-                            uDist += 5;
+                            look = rootLook;
                         }
-                        if (!((vis < 2 && dVis < 2) || vis == dVis))
+                        else if (c.dist == 0 && rcs)
                         {
-                            dDist += 5;
+                            look = commaLook + c.vis;
                         }
-                    }
-                    else // if we're disabled everything is kinda dim
-                    {
-                        dist = 3;
-                        hDist = 3;
-                        uDist = 3;
-                        dDist = 3;
-                    }
 
-                    // Horizontal Line
-                    alpha = 1.f / (std::sqrt(hDist) + 1);
-                    lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    juce::Line<float> horiz(x, y, x + vhDistance, y);
-                    lG.drawLine(horiz, thickness);
-
-                    // Upward Line
-                    alpha = 1.f / (std::sqrt(uDist) + 1);
-                    lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    juce::Line<float> up(x, y, x + (vhDistance * .5f), y - vhDistance);
-                    float ul[2] = {7.f, 3.f};
-                    lG.drawDashedLine(up, ul, 2, thickness, 1);
-
-                    // Downward Line
-                    alpha = 1.f / (std::sqrt(dDist) + 1);
-                    lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    juce::Line<float> down(x, y, x + (vhDistance * .5f), y + vhDistance);
-                    float dl[2] = {2.f, 3.f};
-                    lG.drawDashedLine(down, dl, 2, thickness, 1);
-
-                    // Spheres
-                    juce::Path e{};
-                    e.addEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
-                    // And their shadows
-                    juce::Path b{};
-                    b.addEllipse(x - ellipseRadius - shadowSpacing1, y - JIRadius - shadowSpacing1,
-                                 2 * ellipseRadius + shadowSpacing2, 2 * JIRadius + shadowSpacing2);
-
-                    // Select gradient colour
-                    juce::ColourGradient gradient{};
-
-                    bool rcs = (vis > 1 && vis != 17);
-                    if (degree == 0)
-                    {
-                        gradient = Gradients.rootGrad(x);
-                    }
-                    else if (enabled && dist == 0 && rcs)
-                    {
-                        gradient = Gradients.commaGrad(vis, x);
-                    }
-                    else
-                    {
-                        gradient = Gradients.latticeGrad(v, x);
+                        // far off ones are flat, see detailDistance()
+                        bool flat = lowPower || c.dist > detail;
+                        stamp(tG, sphereSprite(look, alpha, flat), x, y, scale);
+                        continue;
                     }
 
-                    alpha = 1.f / (std::sqrt(dist) + 1);
-                    whiteShadow.setOpacity(alpha);
-                    whiteShadow.render(sG, e);
-                    blackShadow.setOpacity(alpha);
-                    blackShadow.render(sG, b);
-                    sG.setColour(juce::Colours::black);
-                    sG.fillPath(b);
-                    gradient.multiplyOpacity(alpha);
-                    sG.setGradientFill(gradient);
-                    sG.fillPath(e);
-                    sG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    sG.drawEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius,
-                                   thickness);
+                    if (c.dist > detail) // or its name
+                        continue;
 
                     // Names or Ratios?
 
@@ -432,268 +946,189 @@ struct LatticeComponent : juce::Component, private juce::MultiTimer
                     // }
                     // auto s = std::to_string(n) + "/" + std::to_string(d);
 
-                    auto s = nameNoteOnLattice(w, v, degreeTransposed, dist == 0);
+                    auto &glyphs = labels.get(w, v, c.tag, slot, [&](juce::GlyphArrangement &ga) {
+                        layOutLabel(ga, label(w, v, c.degreeTransposed, c.dist == 0));
+                    });
                     tG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    tG.setFont(stoke);
-
-                    tG.drawFittedText(s, x - ellipseRadius + 3, y - (JIRadius / 3.f),
-                                      2.f * (ellipseRadius - 3), .66667f * JIRadius,
-                                      juce::Justification::horizontallyCentred, 1, 0.05f);
+                    glyphs.draw(tG, juce::AffineTransform::translation(x, y));
                 }
             }
         }
-        g.drawImageAt(Lines, 0, 0, false);
-        g.drawImageAt(Spheres, 0, 0, false);
-        g.drawImageAt(Text, 0, 0, false);
-
-        if (enabled)
-        {
-            auto b = this->getLocalBounds();
+    }
 
-            g.setColour(lattices::colours::background);
-            g.fillRect(b.getRight() - 110, b.getBottom() - 110, 101, 101);
-            g.setColour(juce::Colours::ghostwhite);
-            g.drawRect(b.getRight() - 110, b.getBottom() - 110, 101, 101);
-        }
+    // steps along the processor's generators, whichever they are
+    std::pair<uint64_t, uint64_t> calculateCell(int fifths, int thirds)
+    {
+        return proc->jim.cellRatio(fifths, thirds);
     }
 
-  protected:
-    LatticesProcessor *proc;
-    JIMath jim;
+    void reCalculateCell(uint64_t &n, uint64_t &d, int degree)
+    {
+        auto major = proc->currentVisitors->layout().major[degree];
+
+        // take out one row comma, add in the visiting, reduce by GDC
+        auto synt = proc->latticeLayout.rowComma.getFraction(!major);
+        n *= synt.first;
+        d *= synt.second;
+        auto vc = proc->currentVisitors->CC[degree].getFraction(major);
+        auto [nn, nd] = JIMath::multiplyRatio(n, d, vc.first, vc.second);
+        auto gcd = std::gcd(nn, nd);
 
-    int JIRadius{26};
-    int ellipseRadius = JIRadius * 1.15;
+        n = nn / gcd;
+        d = nd / gcd;
+    }
 
-    juce::ReferenceCountedObjectPtr<juce::Typeface> Stoke{juce::Typeface::createSystemTypefaceFor(
-        LatticesBinary::Stoke_otf, LatticesBinary::Stoke_otfSize)};
-    juce::Font stoke{juce::FontOptions(Stoke).withPointHeight(JIRadius)};
+  private:
+    int syntonicDrift{0}, diesisDrift{0}, procX{0}, procY{0};
+    uint64_t seenTuning{0};
+    float xShift{0}, yShift{0}, priorX{0}, priorY{0}, goalX{0}, goalY{0};
 
-    lattices::colours::GradientProvider Gradients;
-    melatonin::DropShadow blackShadow = {juce::Colours::black, JIRadius / 3};
-    melatonin::DropShadow whiteShadow = {juce::Colours::ghostwhite, JIRadius / 2};
+    // How much bigger than JIRadius the spheres look. While zooming the tiles
+    // drawn at JIRadius are just stretched, and once it stops the radius
+    // catches up and they're drawn again, see settleZoom().
+    float viewZoom{1.f};
+    static constexpr int minRadius{15}, maxRadius{42};
 
-    // how far is a given coordinate from the currently active ones?
-    virtual int calcDist(std::pair<int, int> xy)
-    {
-        int res{INT_MAX};
+    bool panning{false};
+    float panFromX{0}, panFromY{0};
 
-        for (int i = 0; i < 12; ++i)
-        {
-            int tx = std::abs(xy.first - proc->coOrds[i].first);
-            int ty = std::abs(xy.second - proc->coOrds[i].second);
-            int sum = tx + ty;
-            if (sum < res)
-                res = sum;
-        }
+    // What's under the mouse, written up in a box above the group buttons.
+    // It's only worked out again when that changes, and only the box is
+    // repainted, so moving the mouse about never draws a tile over.
+    std::optional<std::pair<int, int>> hovered;
+    juce::String hoverText;
+    juce::Font readoutFont{juce::FontOptions(Stoke).withPointHeight(14)};
 
-        return res;
-    }
+    juce::Rectangle<int> readoutArea() const { return {10, getHeight() - 80, 300, 25}; }
 
-    std::pair<uint64_t, uint64_t> calculateCell(int fifths, int thirds)
+    void hover(std::optional<std::pair<int, int>> cell, bool force = false)
     {
-        uint64_t n{1}, d{1};
+        if (cell == hovered && !force)
+            return;
 
-        while (thirds > 0)
-        {
-            auto [nn, dd] = jim.multiplyRatio(n, d, 5, 4);
-            n = nn;
-            d = dd;
-            thirds--;
-        }
+        hovered = cell;
+        hoverText = hovered ? describe(hovered->first, hovered->second) : juce::String{};
+        repaint(readoutArea());
+    }
 
-        while (thirds < 0)
-        {
-            auto [nn, dd] = jim.divideRatio(n, d, 5, 4);
-            n = nn;
-            d = dd;
-            thirds++;
-        }
+    juce::Point<float> centre() const { return {getWidth() / 2.f, getHeight() / 2.f}; }
 
-        while (fifths > 0)
-        {
-            auto [nn, dd] = jim.multiplyRatio(n, d, 3, 2);
-            n = nn;
-            d = dd;
-            fifths--;
-        }
-
-        while (fifths < 0)
-        {
-            auto [nn, dd] = jim.divideRatio(n, d, 3, 2);
-            n = nn;
-            d = dd;
-            fifths++;
-        }
+    // zoom by factor, keeping whatever's under at where it is
+    void zoomAbout(float factor, juce::Point<float> at)
+    {
+        float shown = juce::jlimit<float>(minRadius, maxRadius, JIRadius * viewZoom * factor);
+        float z = shown / JIRadius;
 
-        auto g = std::gcd(n, d);
-        n = n / g;
-        d = d / g;
+        float cx = at.x - getWidth() / 2.f, cy = at.y - getHeight() / 2.f;
+        xShift += cx / viewZoom - cx / z;
+        yShift -= cy / viewZoom - cy / z;
+        viewZoom = z;
 
-        return {n, d};
+        repaint();
+        startTimer(1, 200); // until it's been still for this long
     }
 
-    virtual void reCalculateCell(uint64_t &n, uint64_t &d, int degree)
+    // draw at the nearest whole radius to what's shown, and stop stretching
+    void settleZoom()
     {
-        auto major = lattices::scaledata::isDegreeMajor[degree];
+        int r = juce::jlimit(minRadius, maxRadius, juce::roundToInt(JIRadius * viewZoom));
+        float ratio = static_cast<float>(r) / JIRadius;
 
-        // take out one syntonic comma, add in the visiting, reduce by GDC
-        auto synt = lattices::scaledata::commas[lattices::scaledata::syntonic].getFraction(!major);
-        n *= synt.first;
-        d *= synt.second;
-        auto vc = proc->currentVisitors->CC[degree].getFraction(degree);
-        auto [nn, nd] = jim.multiplyRatio(n, d, vc.first, vc.second);
-        auto gcd = std::gcd(nn, nd);
+        // the shifts are in the lattice's own pixels, which are about to change size
+        xShift *= ratio;
+        yShift *= ratio;
+        priorX *= ratio;
+        priorY *= ratio;
+        viewZoom = 1.f;
 
-        n = nn / gcd;
-        d = nd / gcd;
-    }
+        if (r == JIRadius)
+        {
+            repaint();
+            return;
+        }
 
-  private:
-    int syntonicDrift{0}, diesisDrift{0}, procX{0}, procY{0};
-    float xShift{0}, yShift{0}, priorX{0}, priorY{0}, goalX{0}, goalY{0};
+        setRadius(r);
+        clearSprites();
+        invalidateTiles();
+    }
 
     bool homeFlag{false}, westFlag{false}, eastFlag{false}, northFlag{false}, southFlag{false},
-        visitorFlag{false};
-
-    const std::string noteNames[7] = {"F", "C", "G", "D", "A", "E", "B"};
+        septimalUpFlag{false}, septimalDownFlag{false}, undecimalUpFlag{false},
+        undecimalDownFlag{false}, visitorFlag{false};
 
     std::unique_ptr<juce::TextButton> zoomOutButton;
     std::unique_ptr<juce::TextButton> zoomInButton;
 
     std::unique_ptr<juce::ShapeButton> homeButton;
     std::vector<std::unique_ptr<juce::ArrowButton>> arrowButtons;
-    std::vector<std::unique_ptr<juce::TextButton>> visButtons;
 
-    juce::VBlankAnimatorUpdater updater{this};
+    // each group's button shows what it'd do, see GroupThumbnails.h
+    lattices::render::GroupThumbnails thumbnails{*proc, 35, 35};
+    std::unique_ptr<lattices::render::GroupStrip> visButtons;
+
+    // Only there while we're following, it'd wake us every frame otherwise.
+    // It can't go from inside its own callback, so a timer sees it off.
+    std::unique_ptr<juce::VBlankAnimatorUpdater> updater;
     juce::Animator follow =
         juce::ValueAnimatorBuilder{}
             .withEasing(juce::Easings::createEaseInOut())
             .withDurationMs(1000)
             .withValueChangedCallback([this](auto value) { shiftToFollow((float)value); })
+            .withOnCompleteCallback([this] { startTimer(2, 1); })
             .build();
 
+    void startFollowing()
+    {
+        stopTimer(2);
+        if (!updater)
+        {
+            updater = std::make_unique<juce::VBlankAnimatorUpdater>(this);
+            updater->addAnimator(follow);
+        }
+        follow.start();
+    }
+
+    // Held keys repeat faster than we want to step, so each counts once and
+    // then not again until this goes off.
+    void holdKeys() { startTimer(0, 50); }
+
     void shiftToFollow(const float v)
     {
+        if (panning)
+            return; // they've got hold of it
+
         float dist = JIRadius * 2.f * (5.f / 3.f);
         auto nv = 1 - v;
 
         xShift = nv * priorX + v * dist * (goalX + goalY * .5f);
         yShift = nv * priorY + v * dist * goalY;
 
+        // the tiles don't care where we are, they just get drawn somewhere else
         repaint();
 
         // if (follow.isComplete())
     }
-
-    std::string nameNoteOnLattice(int x, int y, int degree, bool lit = false)
-    {
-        int origin = proc->originNoteName.first + proc->originNoteName.second * 7;
-        int location = x + y * 4 + origin;
-        int letter = ((location % 7) + 7) % 7;
-        std::string name = noteNames[letter];
-
-        while (location >= 7)
-        {
-            // if it already has a sharp
-            if (name.compare(name.size() - 1, 1, "#") == 0)
-            {
-                name.pop_back(); // replace it
-                name += "*";     // with a double sharp
-            }
-            else
-            {
-                name += "#";
-            }
-
-            location -= 7;
-        }
-        while (location < 0)
-        {
-            if (name.compare(name.size() - 1, 1, "b") == 0)
-            {
-                name.pop_back();
-                name += "c";
-            }
-            else
-            {
-                name += "b";
-            }
-
-            location += 7;
-        }
-
-        auto row = y;
-
-        int visitor = proc->currentVisitors->CC[degree].nameIndex;
-
-        if (lit && visitor > 1)
-        {
-            bool major = lattices::scaledata::isDegreeMajor[degree];
-
-            // Remove a plus/minus, to be replaced by another accidental
-            row += (major) ? -1 : 1;
-
-            auto visAcc = ""; // visitor accidental
-
-            switch (visitor)
-            {
-            case 2:
-                visAcc = (major) ? ")" : "(";
-                break;
-            case 3:
-                visAcc = (major) ? ">" : "<";
-                break;
-            case 4:
-                visAcc = (major) ? "{" : "}";
-                break;
-            case 5:
-                visAcc = (major) ? ":" : ";";
-                break;
-            case 6:
-                visAcc = (major) ? "," : ".";
-                break;
-            default:
-                break;
-            }
-
-            name += visAcc;
-        }
-
-        while (row > 0)
-        {
-            name += "-";
-            --row;
-        }
-        while (row < 0)
-        {
-            name += "+";
-            ++row;
-        }
-
-        return name;
-    }
 };
 
 // =================================================================================================
 
-template <typename buttonUser> struct SmallLatticeComponent : LatticeComponent
+
+template <typename buttonUser>
+struct SmallLatticeComponent
+    : juce::Component,
+      protected lattices::render::LatticeCore<lattices::render::VisitorCells,
+                                              lattices::render::Ratios>,
+      private lattices::ChangeBus::Subscriber
 {
     SmallLatticeComponent(buttonUser *bu, LatticesProcessor &p, int size = 30)
-        : buttonParent(bu), LatticeComponent(p, true)
+        : LatticeCore(p, size), buttonParent(bu)
     {
-        JIRadius = size;
-        ellipseRadius = JIRadius * 1.15;
-        stoke.setPointHeight(JIRadius);
-
-        blackShadow.setRadius(JIRadius / 3);
-        whiteShadow.setRadius(JIRadius / 2);
-
         circleShape.addEllipse(0, 0, ellipseRadius, JIRadius);
 
         juce::Colour n{juce::Colours::transparentWhite};
         juce::Colour o{juce::Colours::ghostwhite.withAlpha(.15f)};
 
-        for (int d = 0; d < 12; ++d)
+        for (int d = 0; d < lattices::scaledata::maxDegrees; ++d)
         {
             buttons.push_back(std::make_unique<juce::ShapeButton>(std::to_string(d), n, o, o));
             buttons[d]->setShape(circleShape, true, true, false);
@@ -703,191 +1138,234 @@ template <typename buttonUser> struct SmallLatticeComponent : LatticeComponent
             buttons[d]->setClickingTogglesState(true);
         }
         buttons[0]->setToggleState(true, juce::dontSendNotification);
+
+        // the spheres move when the visitors do, and their buttons with them
+        proc->changes.subscribe(lattices::ChangeBus::Tuning, this);
+        proc->changes.subscribe(lattices::ChangeBus::Visitors, this);
+        proc->changes.subscribe(lattices::ChangeBus::StateLoaded, this);
+        proc->changes.subscribe(lattices::ChangeBus::Appearance, this);
     }
 
-    void resized() override {}
+    ~SmallLatticeComponent() override { proc->changes.unsubscribe(this); }
+
+    void resized() override { layoutButtons(); }
+
+    void enablementChanged() override
+    {
+        layoutButtons();
+        repaint();
+    }
+
+    void changed(lattices::ChangeBus::Topic) override
+    {
+        layoutButtons();
+        repaint();
+    }
 
     void paint(juce::Graphics &g) override
     {
+        lattices::allocations::FrameCounter frame{"Mini lattice paint"};
+
         auto bounds = this->getLocalBounds();
         g.setColour(juce::Colour{.475f, 1.f, 0.05f, 1.f});
         g.fillRect(bounds);
         g.setColour(juce::Colours::ghostwhite);
         g.drawRect(bounds);
 
+        if (getWidth() <= 0 || getHeight() <= 0)
+            return;
+
         bool enabled = this->isEnabled();
-        for (int d = 0; d < 12; ++d)
+        float scale = juce::jlimit(.25f, 8.f, g.getInternalContext().getPhysicalPixelScaleFactor());
+        if (scale != spriteScale || proc->lowPower != spritesFlat)
         {
-            buttons[d]->setEnabled(enabled);
+            spriteScale = scale;
+            spritesFlat = proc->lowPower;
+            for (auto &s : sprites)
+                s = juce::Image{};
         }
 
-        int shadowSpacing1 = JIRadius / 20;
-        int shadowSpacing2 = JIRadius / 10;
-        auto a = enabled ? .75f : .5f;
-
-        whiteShadow.setColor(juce::Colours::ghostwhite.withAlpha(a));
-        blackShadow.setColor(juce::Colours::black.withAlpha(a));
+        float vhDistance = 2.0f * JIRadius * (5.f / 3.f);
+        float thickness = JIRadius / 9.f;
 
-        float ctrDistance{JIRadius * (5.f / 3.f)};
+        // All the lines first, so they're under every sphere
+        for (auto &l : lines)
+            l.clear();
+        forEachLit([&](int w, int v, float x, float y, int) {
+            if (field.degree(w + 1, v) >= 0) // next sphere over
+            {
+                lines[0].startNewSubPath(x, y);
+                lines[0].lineTo(x + vhDistance, y);
+            }
+            if (field.degree(w, v + 1) >= 0) // next sphere up
+            {
+                float ul[2] = {7.f, 3.f};
+                addDashes(lines[1], x, y, x + (vhDistance * .5f), y - vhDistance, ul);
+            }
+            if (field.degree(w + 1, v - 1) >= 0) // next sphere down
+            {
+                float dl[2] = {2.f, 3.f};
+                addDashes(lines[2], x, y, x + (vhDistance * .5f), y + vhDistance, dl);
+            }
+        });
+        g.setColour(juce::Colours::ghostwhite.withAlpha(enabled ? .9f : .5f));
+        for (auto &l : lines)
+            strokeInto(g, l, thickness, stroked);
+
+        // then the spheres, with their ratios on
+        forEachLit([&](int w, int v, float x, float y, int degree) {
+            bool selected = (degree == selectedDegree);
+            auto vis = proc->currentVisitors->CC[degree].nameIndex;
+            stamp(g, sphereSprite(vis, enabled, selected), x, y, scale);
+
+            // only lay the ratio out again when it changes
+            auto ratio = lattices::render::Ratios::ratio(*proc, degree);
+            if (ratioLabels[degree].first != ratio)
+            {
+                auto &ga = ratioLabels[degree].second;
+                ratioLabels[degree].first = ratio;
+                ga.clear();
+                layOutLabel(ga, label(w, v, degree, true));
+            }
+            g.setColour(juce::Colours::ghostwhite.withAlpha(selected ? 1.f : .75f));
+            ratioLabels[degree].second.draw(g, juce::AffineTransform::translation(x, y));
+        });
+    }
 
-        float vhDistance = 2.0f * ctrDistance;
+    int selectedDegree{0};
 
-        auto ctrX = getWidth() / 2 - ctrDistance;
-        auto ctrH = getHeight() / 2;
+  protected:
+    buttonUser *buttonParent;
+    juce::Path circleShape;
+    std::vector<std::unique_ptr<juce::ShapeButton>> buttons;
 
-        auto nV = std::ceil(getHeight() / vhDistance);
-        auto nW = std::ceil(getWidth() / vhDistance);
+    melatonin::DropShadow selectedHighlight = {juce::Colours::ghostwhite, 18};
 
-        juce::Image Lines{juce::Image::ARGB, getWidth(), getHeight(), true};
-        juce::Image Spheres{juce::Image::ARGB, getWidth(), getHeight(), true};
-        {
-            juce::Graphics lG(Lines);
-            juce::Graphics sG(Spheres);
-            for (int v = -nV; v < nV; ++v)
-            {
-                float off = v * vhDistance * 0.5f;
-                float y = -v * vhDistance + ctrH;
-                if (y < 0 || y > getHeight())
-                    continue;
+    // a sphere for each comma, enabled or not, selected or not
+    std::array<juce::Image, lattices::scaledata::maxCommas * 4> sprites;
+    float spriteScale{0.f};
+    bool spritesFlat{false}; // drawn without shadows, for low power mode
 
-                for (int w = -nW; w < nW; ++w)
-                {
-                    float x = w * vhDistance + ctrX + off;
+    // and the paths the lines are gathered into, kept so they don't allocate
+    std::array<juce::Path, 3> lines;
+    juce::Path stroked;
 
-                    if (x < 0 || x > getWidth())
-                        continue;
+    std::array<std::pair<std::pair<uint64_t, uint64_t>, juce::GlyphArrangement>,
+               lattices::scaledata::maxDegrees>
+        ratioLabels{};
 
-                    std::pair<int, int> C = {w, v}; // current sphere
-                    auto dist = calcDist(C);
-                    int degree{0};
-                    if (dist == 0)
-                    {
-                        for (int i = 0; i < 12; ++i)
-                        {
-                            if (proc->currentVisitors->CO[i] == C)
-                            {
-                                degree = i;
-                                break;
-                            }
-                        }
-                        buttons[degree]->setBounds(x - ellipseRadius, y - JIRadius,
-                                                   2 * ellipseRadius, 2 * JIRadius);
-                    }
-                    else
-                    {
-                        continue;
-                    }
+    const juce::Image &sphereSprite(int vis, bool enabled, bool selected)
+    {
+        auto &sprite = sprites[(vis * 2 + enabled) * 2 + selected];
+        if (sprite.isValid())
+            return sprite;
+
+        int margin = std::max(JIRadius / 2, 18) + JIRadius / 10 + 2;
+        sprite = makeSprite(margin, spriteScale, [&](juce::Graphics &sG, float x, float y) {
+            int shadowSpacing1 = JIRadius / 20;
+            int shadowSpacing2 = JIRadius / 10;
+            float thickness = JIRadius / 9.f;
+            auto a = enabled ? .75f : .5f;
+
+            whiteShadow.setColor(juce::Colours::ghostwhite.withAlpha(a));
+            blackShadow.setColor(juce::Colours::black.withAlpha(a));
+
+            // Spheres
+            juce::Path e{};
+            e.addEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
+            // And their shadows
+            juce::Path b{};
+            b.addEllipse(x - ellipseRadius - shadowSpacing1, y - JIRadius - shadowSpacing1,
+                         2 * ellipseRadius + shadowSpacing2, 2 * JIRadius + shadowSpacing2);
+
+            // Select gradient colour
+            auto gradient = Gradients.commaGrad(vis, x);
+
+            if (selected && enabled && !spritesFlat)
+            {
+                selectedHighlight.render(sG, b);
+            }
+            else if (!spritesFlat) // no shadows at all in low power mode
+            {
+                whiteShadow.render(sG, e);
+                blackShadow.render(sG, b);
+            }
+            sG.setColour(juce::Colours::black.withAlpha(1.f));
+            sG.fillPath(b);
+            float alpha = selected ? 1.f : .75f;
+            gradient.multiplyOpacity(alpha);
+            sG.setGradientFill(gradient);
+            sG.fillPath(e);
+            sG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
+            sG.drawEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius,
+                           thickness);
+        });
+        return sprite;
+    }
 
-                    std::pair<int, int> H = {w + 1, v};     // next sphere over
-                    std::pair<int, int> U = {w, v + 1};     // next sphere up
-                    std::pair<int, int> D = {w + 1, v - 1}; // next sphere down
+    // Calls f(w, v, x, y, degree) for every lit sphere that's on us. Painting
+    // and laying out the buttons both go by this, so they always agree.
+    template <typename F> void forEachLit(F &&f)
+    {
+        float ctrDistance{JIRadius * (5.f / 3.f)};
 
-                    bool hLit = calcDist(H) == 0;
-                    bool uLit = calcDist(U) == 0;
-                    bool dLit = calcDist(D) == 0;
-                    float alpha = enabled ? .9f : .5f;
+        float vhDistance = 2.0f * ctrDistance;
 
-                    float thickness = JIRadius / 9.f;
+        auto ctrX = getWidth() / 2 - ctrDistance;
+        auto ctrH = getHeight() / 2;
 
-                    if (hLit) // Horizontal Line
-                    {
-                        lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                        juce::Line<float> horiz(x, y, x + vhDistance, y);
-                        lG.drawLine(horiz, thickness);
-                    }
+        int nV = static_cast<int>(std::ceil(getHeight() / vhDistance));
+        int nW = static_cast<int>(std::ceil(getWidth() / vhDistance));
 
-                    if (uLit) // Upward Line
-                    {
-                        lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                        juce::Line<float> up(x, y, x + (vhDistance * .5f), y - vhDistance);
-                        float ul[2] = {7.f, 3.f};
-                        lG.drawDashedLine(up, ul, 2, thickness, 1);
-                    }
+        // cheap enough to rebuild every time, it's only as big as we are
+        buildField(-nW, -nV - 1, nW, nV);
 
-                    if (dLit) // Downward Line
-                    {
-                        lG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                        juce::Line<float> down(x, y, x + (vhDistance * .5f), y + vhDistance);
-                        float dl[2] = {2.f, 3.f};
-                        lG.drawDashedLine(down, dl, 2, thickness, 1);
-                    }
+        for (int v = -nV; v < nV; ++v)
+        {
+            float off = v * vhDistance * 0.5f;
+            float y = -v * vhDistance + ctrH;
+            if (y < 0 || y > getHeight())
+                continue;
 
-                    // Spheres
-                    juce::Path e{};
-                    e.addEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius);
-                    // And their shadows
-                    // TODO: make these dependent on constructor size
-                    juce::Path b{};
-                    b.addEllipse(x - ellipseRadius - shadowSpacing1, y - JIRadius - shadowSpacing1,
-                                 2 * ellipseRadius + shadowSpacing2, 2 * JIRadius + shadowSpacing2);
+            for (int w = -nW; w < nW; ++w)
+            {
+                float x = w * vhDistance + ctrX + off;
 
-                    auto vis = proc->currentVisitors->CC[degree].nameIndex;
-                    // Select gradient colour
-                    auto gradient = Gradients.commaGrad(vis, x);
+                if (x < 0 || x > getWidth())
+                    continue;
 
-                    if (degree == selectedDegree && enabled)
-                    {
-                        selectedHighlight.render(sG, b);
-                    }
-                    else
-                    {
-                        whiteShadow.render(sG, e);
-                        blackShadow.render(sG, b);
-                    }
-                    sG.setColour(juce::Colours::black.withAlpha(1.f));
-                    sG.fillPath(b);
-                    alpha = (degree == selectedDegree) ? 1.f : .75f;
-                    gradient.multiplyOpacity(alpha);
-                    sG.setGradientFill(gradient);
-                    sG.fillPath(e);
-                    sG.setColour(juce::Colours::ghostwhite.withAlpha(alpha));
-                    sG.drawEllipse(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius, 2 * JIRadius,
-                                   thickness);
-
-                    uint64_t n{1}, d{1};
-                    reCalculateCell(n, d, degree);
-                    auto s = std::to_string(n) + "/" + std::to_string(d);
-
-                    sG.setFont(stoke);
-                    sG.drawFittedText(s, x - ellipseRadius + 3, y - (JIRadius / 3.f),
-                                      2.f * (ellipseRadius - 3), .66667f * JIRadius,
-                                      juce::Justification::horizontallyCentred, 1, 0.05f);
-                }
+                int degree = field.degree(w, v); // current sphere
+                if (degree >= 0)
+                    f(w, v, x, y, degree);
             }
         }
-        g.drawImageAt(Lines, 0, 0, false);
-        g.drawImageAt(Spheres, 0, 0, false);
     }
 
-    int selectedDegree{0};
-
-  protected:
-    buttonUser *buttonParent;
-    juce::Path circleShape;
-    std::vector<std::unique_ptr<juce::ShapeButton>> buttons;
-
-    melatonin::DropShadow selectedHighlight = {juce::Colours::ghostwhite, 18};
-
-    int calcDist(std::pair<int, int> xy) override
+    // The buttons sit over the spheres they pick, and go where those do. Done
+    // here rather than in paint, so drawing never moves anything about.
+    void layoutButtons()
     {
-        int res{INT_MAX};
-
-        for (int d = 0; d < 12; ++d)
+        bool enabled = this->isEnabled();
+        int numDegrees = proc->currentVisitors->numDegrees;
+        for (int d = 0; d < lattices::scaledata::maxDegrees; ++d)
         {
-            int tx = std::abs(xy.first - proc->currentVisitors->CO[d].first);
-            int ty = std::abs(xy.second - proc->currentVisitors->CO[d].second);
-            int sum = tx + ty;
-            if (sum < res)
-                res = sum;
+            buttons[d]->setEnabled(enabled && d < numDegrees);
+            buttons[d]->setVisible(d < numDegrees);
         }
 
-        return res;
+        if (getWidth() <= 0 || getHeight() <= 0)
+            return;
+
+        forEachLit([this](int, int, float x, float y, int degree) {
+            buttons[degree]->setBounds(x - ellipseRadius, y - JIRadius, 2 * ellipseRadius,
+                                       2 * JIRadius);
+        });
     }
 
     void whichNote()
     {
         int n{};
-        for (int i = 0; i < 12; ++i)
+        for (int i = 0; i < proc->currentVisitors->numDegrees; ++i)
         {
             if (buttons[i]->getToggleState())
             {
@@ -897,17 +1375,6 @@ template <typename buttonUser> struct SmallLatticeComponent : LatticeComponent
         }
         buttonParent->selectNote(n);
     }
-
-    void reCalculateCell(uint64_t &n, uint64_t &d, int degree) override
-    {
-        auto [tn, td] = lattices::scaledata::pyth12fractions[degree];
-        auto [cn, cd] = proc->currentVisitors->CC[degree].getFraction(degree);
-        tn *= cn;
-        td *= cd;
-        auto gcd = std::gcd(tn, td);
-        n = tn / gcd;
-        d = td / gcd;
-    }
 };
 
 #endif // LATTICES_LATTICECOMPONENT_H
@@ -0,0 +1,284 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_LATTICECORE_H
+#define LATTICES_LATTICECORE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <utility>
+
+#include "JIMath.h"
+#include "ScaleData.h"
+#include "LatticesColours.h"
+#include "LatticeField.h"
+#include "LatticeTiles.h"
+#include "LatticesBinary.h"
+#include "LatticesProcessor.h"
+
+#include <melatonin_blur/melatonin_blur.h>
+
+namespace lattices::render
+{
+// Which cells are lit. The big lattice shows the scale as it's tuned right
+// now, the small one the current visitor group's own layout of it.
+struct ScaleCells
+{
+    static std::pair<const std::pair<int, int> *, int> lit(const LatticesProcessor &p)
+    {
+        return {p.coOrds, p.scaleSize};
+    }
+};
+
+struct VisitorCells
+{
+    static std::pair<const std::pair<int, int> *, int> lit(const LatticesProcessor &p)
+    {
+        return {p.currentVisitors->CO.data(), p.currentVisitors->numDegrees};
+    }
+};
+
+// What's written on a sphere: the note's name, spelled from the origin along
+// the processor's generators...
+struct NoteNames
+{
+    static std::string label(const LatticesProcessor &p, int x, int y, int degree, bool lit)
+    {
+        static constexpr const char *noteNames[7] = {"F", "C", "G", "D", "A", "E", "B"};
+
+        // off the 5-limit plane every note moves by the same higher prime ratios
+        lattices::scaledata::coordN_t plane{x, y, p.activePlane};
+
+        // and on it, each step is spelled however its generator is
+        auto &hs = p.jim.horizSpelling;
+        auto &ds = p.jim.diagSpelling;
+        int extra[lattices::scaledata::numExtraAxes] = {
+            plane.axis(0) + x * hs.septimal + y * ds.septimal,
+            plane.axis(1) + x * hs.undecimal + y * ds.undecimal};
+
+        int origin = p.originNoteName.first + p.originNoteName.second * 7;
+        int location = x * hs.fifths + y * ds.fifths + origin;
+        for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+        {
+            location += plane.axis(a) * lattices::scaledata::extraAxes[a].fifths;
+        }
+        int letter = ((location % 7) + 7) % 7;
+        std::string name = noteNames[letter];
+
+        while (location >= 7)
+        {
+            // if it already has a sharp
+            if (name.compare(name.size() - 1, 1, "#") == 0)
+            {
+                name.pop_back(); // replace it
+                name += "*";     // with a double sharp
+            }
+            else
+            {
+                name += "#";
+            }
+
+            location -= 7;
+        }
+        while (location < 0)
+        {
+            if (name.compare(name.size() - 1, 1, "b") == 0)
+            {
+                name.pop_back();
+                name += "c";
+            }
+            else
+            {
+                name += "b";
+            }
+
+            location += 7;
+        }
+
+        auto row = x * hs.syntonic + y * ds.syntonic;
+
+        int visitor = p.currentVisitors->CC[degree].nameIndex;
+
+        if (lit && visitor > 1)
+        {
+            bool major = p.currentVisitors->layout().major[degree];
+
+            // Remove a plus/minus, to be replaced by another accidental
+            row += (major) ? -1 : 1;
+
+            name += p.commaRegistry.accidental(visitor, major);
+        }
+
+        for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+        {
+            auto &axis = lattices::scaledata::extraAxes[a];
+            for (int steps = extra[a]; steps > 0; --steps)
+            {
+                name += axis.upAccidental;
+            }
+            for (int steps = extra[a]; steps < 0; ++steps)
+            {
+                name += axis.downAccidental;
+            }
+        }
+
+        while (row > 0)
+        {
+            name += "-";
+            --row;
+        }
+        while (row < 0)
+        {
+            name += "+";
+            ++row;
+        }
+
+        return name;
+    }
+};
+
+// ...or the ratio the current visitor group tunes that degree to
+struct Ratios
+{
+    static std::pair<uint64_t, uint64_t> ratio(const LatticesProcessor &p, int degree)
+    {
+        auto &layout = p.currentVisitors->layout();
+        auto [tn, td] = layout.fractions[degree];
+        auto [cn, cd] = p.currentVisitors->CC[degree].getFraction(layout.major[degree]);
+        tn *= cn;
+        td *= cd;
+        auto gcd = std::gcd(tn, td);
+        return {tn / gcd, td / gcd};
+    }
+
+    static std::string label(const LatticesProcessor &p, int, int, int degree, bool)
+    {
+        auto [n, d] = ratio(p, degree);
+        return std::to_string(n) + "/" + std::to_string(d);
+    }
+};
+
+// What every lattice has, whatever it lights up and however it names things.
+// Both are known at compile time, so asking them is a plain call that the
+// drawing loops get to inline, not a virtual one per cell.
+template <typename Cells, typename Names> struct LatticeCore
+{
+  protected:
+    LatticeCore(LatticesProcessor &p, int radius) : proc(&p), Gradients(radius, p.commaRegistry)
+    {
+        setRadius(radius);
+    }
+
+    LatticesProcessor *proc;
+
+    int JIRadius{26};
+    int ellipseRadius = JIRadius * 1.15;
+
+    juce::ReferenceCountedObjectPtr<juce::Typeface> Stoke{juce::Typeface::createSystemTypefaceFor(
+        LatticesBinary::Stoke_otf, LatticesBinary::Stoke_otfSize)};
+    juce::Font stoke{juce::FontOptions(Stoke).withPointHeight(JIRadius)};
+
+    lattices::colours::GradientProvider Gradients;
+    melatonin::DropShadow blackShadow = {juce::Colours::black, JIRadius / 3};
+    melatonin::DropShadow whiteShadow = {juce::Colours::ghostwhite, JIRadius / 2};
+
+    // distances and degrees for the cells around the ones we draw
+    lattices::field::LatticeField field;
+
+    void setRadius(int r)
+    {
+        JIRadius = r;
+        ellipseRadius = JIRadius * 1.15;
+        stoke.setPointHeight(JIRadius);
+        blackShadow.setRadius(JIRadius / 3);
+        whiteShadow.setRadius(JIRadius / 2);
+        Gradients.setSize(JIRadius);
+    }
+
+    void buildField(int x0, int y0, int x1, int y1)
+    {
+        auto [lit, n] = Cells::lit(*proc);
+        field.build(x0, y0, x1, y1, lit, n);
+    }
+
+    std::string label(int w, int v, int degree, bool lit) const
+    {
+        return Names::label(*proc, w, v, degree, lit);
+    }
+
+    // centred on the sphere, relative to its middle
+    void layOutLabel(juce::GlyphArrangement &ga, const std::string &s) const
+    {
+        ga.addFittedText(stoke, s, -ellipseRadius + 3, -(JIRadius / 3.f),
+                         2.f * (ellipseRadius - 3), .66667f * JIRadius,
+                         juce::Justification::horizontallyCentred, 1, 0.05f);
+    }
+
+    // One sphere and margin pixels round it, in real pixels at this scale.
+    // draw(g, x, y) draws it centred on (x, y).
+    template <typename F> juce::Image makeSprite(int margin, float scale, F &&draw) const
+    {
+        int halfW = static_cast<int>(std::ceil((ellipseRadius + margin) * scale));
+        int halfH = static_cast<int>(std::ceil((JIRadius + margin) * scale));
+        auto sprite = lattices::tiles::TileCache::makeImage(2 * halfW, 2 * halfH);
+
+        juce::Graphics sG(sprite);
+        sG.addTransform(juce::AffineTransform::scale(scale));
+        draw(sG, halfW / scale, halfH / scale);
+        return sprite;
+    }
+
+    // and that put down centred on (x, y), on a whole pixel so it isn't resampled
+    static void stamp(juce::Graphics &g, const juce::Image &sprite, float x, float y, float scale)
+    {
+        int px = juce::roundToInt(x * scale) - sprite.getWidth() / 2;
+        int py = juce::roundToInt(y * scale) - sprite.getHeight() / 2;
+        auto at = juce::AffineTransform::translation(px, py);
+        g.drawImageTransformed(sprite, at.scaled(1.f / scale));
+    }
+
+    // The dashes Graphics::drawDashedLine(line, dashes, 2, thickness, 1) would
+    // draw, as pieces of a path: a gap, a dash, a gap and so on, each line
+    // starting over.
+    static void addDashes(juce::Path &p, float x1, float y1, float x2, float y2,
+                          const float (&dashes)[2])
+    {
+        float dx = x2 - x1, dy = y2 - y1;
+        float length = std::sqrt(dx * dx + dy * dy);
+        if (length < .1f)
+            return;
+
+        float from = dashes[1];
+        while (from < length)
+        {
+            float to = std::min(from + dashes[0], length);
+            p.startNewSubPath(x1 + dx * from / length, y1 + dy * from / length);
+            p.lineTo(x1 + dx * to / length, y1 + dy * to / length);
+            from = to + dashes[1];
+        }
+    }
+
+    // Strokes p the way lines are, through a path kept for the purpose so
+    // that doing it every frame doesn't allocate
+    static void strokeInto(juce::Graphics &g, const juce::Path &p, float thickness,
+                           juce::Path &stroked)
+    {
+        stroked.clear();
+        juce::PathStrokeType(thickness).createStrokedPath(stroked, p);
+        g.fillPath(stroked);
+    }
+};
+} // namespace lattices::render
+
+#endif // LATTICES_LATTICECORE_H
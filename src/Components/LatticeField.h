@@ -0,0 +1,142 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_LATTICEFIELD_H
+#define LATTICES_LATTICEFIELD_H
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "ScaleData.h"
+
+namespace lattices::field
+{
+// How far every cell in a window of the lattice is from the nearest lit one,
+// and which degree (if any) is lit there. Built once when the tuning or the
+// window changes, so drawing each sphere is array reads instead of a scan over
+// every degree for the sphere and each of its neighbours.
+struct LatticeField
+{
+    // lay the field over [x0, x1] x [y0, y1] and light it up from the coordinates
+    void build(int x0, int y0, int x1, int y1, const std::pair<int, int> *lit, int numLit)
+    {
+        left = x0;
+        bottom = y0;
+        width = std::max(x1 - x0 + 1, 0);
+        height = std::max(y1 - y0 + 1, 0);
+
+        numSources = std::min(numLit, lattices::scaledata::maxDegrees);
+        for (int i = 0; i < numSources; ++i)
+            sources[i] = lit[i];
+
+        // vectors only grow, so rebuilding over a same-sized window doesn't allocate
+        dist.assign(width * height, INT_MAX / 2);
+        degrees.assign(width * height, -1);
+        if (width == 0 || height == 0)
+            return;
+
+        // A lit cell outside the window is as far from any cell inside as its
+        // nearest cell on the edge, plus the distance to that edge.
+        for (int i = 0; i < numSources; ++i)
+        {
+            auto [x, y] = sources[i];
+            int cx = std::clamp(x, x0, x1);
+            int cy = std::clamp(y, y0, y1);
+            int c = index(cx, cy);
+            dist[c] = std::min(dist[c], std::abs(x - cx) + std::abs(y - cy));
+            if (cx == x && cy == y)
+                degrees[c] = i; // a later degree on the same cell wins, as in active_cells_t
+        }
+
+        // Two passes of the Manhattan distance transform, the same answer as a
+        // breadth first search out from every lit cell at once.
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                int &d = dist[y * width + x];
+                if (x > 0)
+                    d = std::min(d, dist[y * width + x - 1] + 1);
+                if (y > 0)
+                    d = std::min(d, dist[(y - 1) * width + x] + 1);
+            }
+        }
+        for (int y = height - 1; y >= 0; --y)
+        {
+            for (int x = width - 1; x >= 0; --x)
+            {
+                int &d = dist[y * width + x];
+                if (x < width - 1)
+                    d = std::min(d, dist[y * width + x + 1] + 1);
+                if (y < height - 1)
+                    d = std::min(d, dist[(y + 1) * width + x] + 1);
+            }
+        }
+    }
+
+    bool covers(int x0, int y0, int x1, int y1) const
+    {
+        return x0 >= left && y0 >= bottom && x1 < left + width && y1 < bottom + height;
+    }
+
+    // Manhattan distance to the nearest lit cell
+    int distance(int x, int y) const
+    {
+        if (inside(x, y))
+            return dist[index(x, y)];
+
+        // shouldn't happen, but answer the long way round rather than wrongly
+        int res{INT_MAX};
+        for (int i = 0; i < numSources; ++i)
+        {
+            int sum = std::abs(x - sources[i].first) + std::abs(y - sources[i].second);
+            if (sum < res)
+                res = sum;
+        }
+        return res;
+    }
+
+    // the degree lit at this cell, or -1
+    int degree(int x, int y) const
+    {
+        if (inside(x, y))
+            return degrees[index(x, y)];
+
+        for (int i = numSources - 1; i >= 0; --i)
+        {
+            if (sources[i] == std::make_pair(x, y))
+                return i;
+        }
+        return -1;
+    }
+
+  private:
+    int left{0}, bottom{0}, width{0}, height{0};
+
+    std::array<std::pair<int, int>, lattices::scaledata::maxDegrees> sources{};
+    int numSources{0};
+
+    std::vector<int> dist;
+    std::vector<int> degrees;
+
+    bool inside(int x, int y) const
+    {
+        return x >= left && y >= bottom && x < left + width && y < bottom + height;
+    }
+    int index(int x, int y) const { return (y - bottom) * width + (x - left); }
+};
+} // namespace lattices::field
+
+#endif // LATTICES_LATTICEFIELD_H
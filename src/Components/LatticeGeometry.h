@@ -0,0 +1,85 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_LATTICEGEOMETRY_H
+#define LATTICES_LATTICEGEOMETRY_H
+
+#include <cmath>
+#include <optional>
+#include <utility>
+
+namespace lattices::geometry
+{
+// Where things are on the big lattice. Cell (w, v) sits at ((w + v / 2) * vh, -v * vh)
+// in the lattice's own pixels, rows vh apart, and the view puts the lattice's
+// (xShift, -yShift) in the middle of the component, zoomed.
+struct view_t
+{
+    float width, height; // the component's
+    float xShift, yShift, zoom;
+
+    // a point on the component, in the lattice's pixels
+    std::pair<float, float> toLattice(float px, float py) const
+    {
+        return {xShift + (px - width / 2.f) / zoom, (py - height / 2.f) / zoom - yShift};
+    }
+};
+
+inline std::pair<float, float> centreOf(int w, int v, float vh)
+{
+    return {(w + v * .5f) * vh, -v * vh};
+}
+
+// The cell whose sphere, rx across and ry up from its centre, is at (x, y) in
+// the lattice's pixels, if there's one there. Undo the skew to get to
+// fractional cells, then it's one of the four around those.
+inline std::optional<std::pair<int, int>> cellAt(float x, float y, float vh, float rx, float ry)
+{
+    std::optional<std::pair<int, int>> res;
+    float best{1.f}; // inside the sphere's ellipse, or it doesn't count
+    int v0 = static_cast<int>(std::floor(-y / vh));
+    for (int v = v0; v <= v0 + 1; ++v)
+    {
+        int w0 = static_cast<int>(std::floor(x / vh - v * .5f));
+        for (int w = w0; w <= w0 + 1; ++w)
+        {
+            auto [cx, cy] = centreOf(w, v, vh);
+            float dx = (x - cx) / rx;
+            float dy = (y - cy) / ry;
+            float dist = dx * dx + dy * dy;
+            if (dist <= best)
+            {
+                best = dist;
+                res = std::make_pair(w, v);
+            }
+        }
+    }
+    return res;
+}
+
+// Where the position parameters go for the root, at root now, to land on cell, kept
+// within reach. That only works where the root follows the position one for one:
+// Syntonic mode steps columns and rows of its block instead, so it has no target.
+inline std::optional<std::pair<int, int>> jumpTarget(std::pair<int, int> position,
+                                                     std::pair<int, int> root,
+                                                     std::pair<int, int> cell, int reach,
+                                                     bool rootFollows)
+{
+    if (!rootFollows)
+        return std::nullopt;
+
+    auto clamp = [reach](int n) { return n < -reach ? -reach : (n > reach ? reach : n); };
+    return std::make_pair(clamp(position.first + cell.first - root.first),
+                          clamp(position.second + cell.second - root.second));
+}
+} // namespace lattices::geometry
+
+#endif // LATTICES_LATTICEGEOMETRY_H
@@ -0,0 +1,191 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#ifndef LATTICES_LATTICETILES_H
+#define LATTICES_LATTICETILES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "AllocationCounter.h"
+
+namespace lattices::tiles
+{
+// Square pieces of the drawn lattice. They're placed in the lattice's own
+// pixels rather than ours, so they stay good wherever it's scrolled to, and
+// the least recently used ones are the first to be drawn over. Scrolling back
+// to somewhere we've just been then costs nothing.
+//
+// Those pixels are the display's, not the component's: a tile is tileSize
+// real pixels across at whatever scale we're shown at, so it goes on screen
+// as is instead of being resampled.
+struct TileCache
+{
+    static constexpr int tileSize{256};
+
+    struct tile_t
+    {
+        int x{0}, y{0}; // which tile, counted in tileSizes from the lattice's origin
+        bool valid{false};
+        uint64_t signature{0}; // of every cell drawn on it
+        int version{-1};       // the tuning that signature was checked against
+        uint64_t lastUsed{0};
+        juce::Image image;
+    };
+
+    // everything needs drawing again
+    void invalidate()
+    {
+        for (auto &t : tiles)
+            t.valid = false;
+    }
+
+    // keep at least this many around, so one frame's worth never pushes each other out
+    void reserve(int n)
+    {
+        if (static_cast<int>(tiles.size()) < n)
+            tiles.resize(n);
+    }
+
+    void nextFrame() { ++frame; }
+
+    // how many real pixels to a component one, everything's drawn over if that changes
+    float scale() const { return pixelScale; }
+    void setScale(float s)
+    {
+        if (s == pixelScale)
+            return;
+        pixelScale = s;
+        invalidate();
+    }
+
+    // Software images, so they can be drawn on any thread and come out the
+    // same whichever one it is
+    static juce::Image makeImage(int w, int h)
+    {
+        return juce::Image{juce::Image::ARGB, w, h, true, juce::SoftwareImageType{}};
+    }
+
+    // The tile if we have it. If not, the least recently used one, renamed and
+    // marked invalid so the caller knows to draw it.
+    tile_t &get(int x, int y)
+    {
+        tile_t *oldest{nullptr};
+        for (auto &t : tiles)
+        {
+            if (t.valid && t.x == x && t.y == y)
+            {
+                t.lastUsed = frame;
+                return t;
+            }
+            if (!oldest || (oldest->valid && !t.valid) ||
+                (oldest->valid == t.valid && t.lastUsed < oldest->lastUsed))
+                oldest = &t;
+        }
+
+        jassert(oldest != nullptr); // reserve() first
+        oldest->x = x;
+        oldest->y = y;
+        oldest->valid = false;
+        oldest->lastUsed = frame;
+        if (!oldest->image.isValid())
+            oldest->image = makeImage(tileSize, tileSize);
+        return *oldest;
+    }
+
+  private:
+    std::vector<tile_t> tiles;
+    uint64_t frame{0};
+    float pixelScale{1.f};
+};
+
+// Draws a frame's worth of tiles on a few threads at once, this one included.
+// Each tile is drawn start to finish by one of them onto its own image, so
+// the result is the same as drawing them one after another.
+struct TileWorkers
+{
+    TileWorkers()
+        : pool(juce::ThreadPoolOptions{}
+                   .withThreadName("Lattice tiles")
+                   .withNumberOfThreads(numWorkers()))
+    {
+        for (int i = 0; i < numWorkers(); ++i)
+            workers.push_back(std::make_unique<worker_t>(*this, i + 1));
+    }
+
+    ~TileWorkers() { pool.removeAllJobs(true, -1); }
+
+    // How many threads can be drawing at once: the one calling run() is slot 0 and
+    // each worker has its own after that. Per-thread scratch space goes in a slot,
+    // owned by whoever's drawing, so none of it outlives them.
+    static int numSlots() { return numWorkers() + 1; }
+
+    // calls draw(i, slot) for every i in [0, n), and returns once they're all done
+    void run(int n, const std::function<void(int, int)> &draw)
+    {
+        job = &draw;
+        numJobs = n;
+        next = 0;
+
+        // not worth waking anyone up for just the one
+        int helpers = std::min(static_cast<int>(workers.size()), n - 1);
+        for (int i = 0; i < helpers; ++i)
+            pool.addJob(workers[i].get(), false);
+
+        work(0);
+
+        for (int i = 0; i < helpers; ++i)
+            pool.waitForJobToFinish(workers[i].get(), -1);
+        job = nullptr;
+    }
+
+  private:
+    struct worker_t : juce::ThreadPoolJob
+    {
+        worker_t(TileWorkers &o, int s) : juce::ThreadPoolJob("Lattice tile"), owner(o), slot(s)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            // anything allocated here is the painting frame's, see AllocationCounter.h
+            auto before = lattices::allocations::count;
+            owner.work(slot);
+            lattices::allocations::lent += lattices::allocations::count - before;
+            return jobHasFinished;
+        }
+
+        TileWorkers &owner;
+        int slot;
+    };
+
+    static int numWorkers() { return std::clamp(juce::SystemStats::getNumCpus() - 1, 1, 3); }
+
+    void work(int slot)
+    {
+        for (int i = next++; i < numJobs; i = next++)
+            (*job)(i, slot);
+    }
+
+    juce::ThreadPool pool;
+    std::vector<std::unique_ptr<worker_t>> workers;
+
+    const std::function<void(int, int)> *job{nullptr};
+    int numJobs{0};
+    std::atomic<int> next{0};
+};
+} // namespace lattices::tiles
+
+#endif // LATTICES_LATTICETILES_H
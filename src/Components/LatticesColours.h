@@ -5,8 +5,11 @@
 #ifndef LATTICESCOLOURS_H
 #define LATTICESCOLOURS_H
 
+#include <array>
 #include <utility>
 
+#include "ScaleData.h"
+
 namespace lattices::colours
 {
 using JC_t = juce::Colour;
@@ -42,7 +45,31 @@ static std::vector<std::pair<JC_t, JC_t>> comma = {
 
 struct GradientProvider
 {
-    GradientProvider(int r) : radius(r), size(r * 2.f) {}
+    GradientProvider(int r, const lattices::scaledata::comma_registry_t &reg =
+                                lattices::scaledata::builtInCommas)
+        : radius(r), size(r * 2.f)
+    {
+        setCommaColours(reg);
+    }
+
+    // One pair per registry entry. User commas without colours of their own
+    // borrow the plain one, so none of them paint as black.
+    void setCommaColours(const lattices::scaledata::comma_registry_t &r)
+    {
+        for (int i = 0; i < r.size; ++i)
+        {
+            if (r.colourFrom[i] != 0)
+            {
+                JC_t from{r.colourFrom[i]};
+                JC_t to = (r.colourTo[i] != 0) ? JC_t{r.colourTo[i]} : from.withAlpha(.25f);
+                commaColours[i] = std::make_pair(from, to);
+            }
+            else
+            {
+                commaColours[i] = comma[(i < comma.size()) ? i : 0];
+            }
+        }
+    }
 
     void setSize(int r)
     {
@@ -54,7 +81,7 @@ struct GradientProvider
     {
         juce::Rectangle a{p - radius, p + radius, size, size};
 
-        return JCG_t::horizontal(comma[idx].first, comma[idx].second, a);
+        return JCG_t::horizontal(commaColours[idx].first, commaColours[idx].second, a);
     }
 
     JCG_t latticeGrad(int row, float p)
@@ -72,6 +99,7 @@ struct GradientProvider
   protected:
     int radius;
     float size;
+    std::array<std::pair<JC_t, JC_t>, lattices::scaledata::maxCommas> commaColours;
 };
 } // namespace lattices::colours
 #endif // LATTICESCOLOURS_H
@@ -42,8 +42,12 @@ struct MenuBarComponent : juce::Component
         visButton->setClickingTogglesState(true);
         visButton->setToggleState(false, juce::dontSendNotification);
 
+        // Each panel keeps an image of itself, so the lattice being drawn
+        // underneath only has them put back on top. Only the panels though,
+        // an image of the bar as well would just hold another copy of them.
         visC = std::make_unique<VisitorsComponent>(proc);
         addAndMakeVisible(*visC);
+        visC->setBufferedToImage(true);
         visC->setVisible(false);
 
         settingsButton = std::make_unique<juce::ShapeButton>("Settings", off, offo, offd);
@@ -57,10 +61,12 @@ struct MenuBarComponent : juce::Component
 
         settingsC = std::make_unique<SettingsComponent>(proc);
         addAndMakeVisible(*settingsC);
+        settingsC->setBufferedToImage(true);
         settingsC->setVisible(false);
 
         originC = std::make_unique<OriginComponent>(proc);
         addAndMakeVisible(*originC);
+        originC->setBufferedToImage(true);
         originC->setVisible(false);
     }
 
@@ -72,7 +78,7 @@ struct MenuBarComponent : juce::Component
         visC->setBounds(0, 30, 750, 300);
 
         settingsButton->setBounds(settingsRect);
-        settingsC->setBounds(600, 30, 120, 200);
+        settingsC->setBounds(600, 30, 120, 300);
         originC->setBounds(360, 30, 240, 95);
     }
 
@@ -16,7 +16,7 @@
 #include <string>
 
 //==============================================================================
-struct OriginComponent : public juce::Component, juce::Timer
+struct OriginComponent : public juce::Component, private lattices::ChangeBus::Subscriber
 {
     OriginComponent(LatticesProcessor &p) : proc(&p)
     {
@@ -58,9 +58,11 @@ struct OriginComponent : public juce::Component, juce::Timer
 
         priorFreq = proc->originalRefFreq;
 
-        startTimer(5);
+        proc->changes.subscribe(lattices::ChangeBus::Origin, this);
     }
 
+    ~OriginComponent() override { proc->changes.unsubscribe(this); }
+
     void resized() override
     {
         for (int i = 0; i < 12; ++i)
@@ -161,7 +163,7 @@ struct OriginComponent : public juce::Component, juce::Timer
         }
     }
 
-    void timerCallback() override
+    void changed(lattices::ChangeBus::Topic) override
     {
         if (proc->originalRefFreq != priorFreq)
         {
@@ -22,6 +22,7 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
     SettingsComponent(LatticesProcessor &p) : proc(&p)
     {
         priorCC = proc->homeCC;
+        priorAxisCC = proc->axisCC;
         priorChannel = proc->listenOnChannel;
         priorDistance = proc->maxDistance;
 
@@ -59,6 +60,23 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
         homeEditor.onEscapeKey = [this] { escapeKeyResponse(&homeEditor); };
         homeEditor.onFocusLost = [this] { focusLostResponse(&homeEditor); };
 
+        addAndMakeVisible(axisLabel);
+        axisLabel.setJustificationType(juce::Justification::left);
+        axisLabel.setColour(juce::Label::backgroundColourId, bg);
+        axisLabel.setColour(juce::Label::outlineColourId, ol);
+
+        addAndMakeVisible(axisEditor);
+        axisEditor.setMultiLine(false);
+        axisEditor.setReturnKeyStartsNewLine(false);
+        axisEditor.setInputRestrictions(3, "1234567890");
+        axisEditor.setText(std::to_string(proc->axisCC), false);
+        axisEditor.setJustification(juce::Justification::centred);
+        axisEditor.setSelectAllWhenFocused(true);
+        axisEditor.setColour(juce::TextEditor::outlineColourId, ol);
+        axisEditor.onReturnKey = [this] { returnKeyResponse(&axisEditor); };
+        axisEditor.onEscapeKey = [this] { escapeKeyResponse(&axisEditor); };
+        axisEditor.onFocusLost = [this] { focusLostResponse(&axisEditor); };
+
         addAndMakeVisible(channelLabel);
         channelLabel.setJustificationType(juce::Justification::left);
         channelLabel.setColour(juce::Label::backgroundColourId, bg);
@@ -94,6 +112,73 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
         {
             duodeneButton.setToggleState(true, juce::dontSendNotification);
         }
+
+        addAndMakeVisible(sizeLabel);
+        sizeLabel.setJustificationType(juce::Justification::left);
+        sizeLabel.setColour(juce::Label::backgroundColourId, bg);
+        sizeLabel.setColour(juce::Label::outlineColourId, ol);
+
+        addAndMakeVisible(sizeBox);
+        for (int i = 0; i < lattices::scaledata::numScaleSizes; ++i)
+        {
+            auto n = lattices::scaledata::scaleSizes[i];
+            sizeBox.addItem(std::to_string(n), n);
+        }
+        sizeBox.setSelectedId(proc->scaleSize, juce::dontSendNotification);
+        sizeBox.setColour(juce::ComboBox::outlineColourId, ol);
+        sizeBox.onChange = [this] { changeSize(sizeBox.getSelectedId()); };
+
+        addAndMakeVisible(genLabel);
+        genLabel.setJustificationType(juce::Justification::left);
+        genLabel.setColour(juce::Label::backgroundColourId, bg);
+        genLabel.setColour(juce::Label::outlineColourId, ol);
+
+        addAndMakeVisible(genBox);
+        for (int i = 0; i < lattices::scaledata::numGeneratorPresets; ++i)
+        {
+            genBox.addItem(lattices::scaledata::generatorPresets[i].name, i + 1);
+        }
+        genBox.setColour(juce::ComboBox::outlineColourId, ol);
+        genBox.onChange = [this]
+        {
+            auto i = genBox.getSelectedId() - 1;
+            if (i < 0)
+                return;
+            auto &p = lattices::scaledata::generatorPresets[i];
+            proc->updateGenerators(p.horizontal.first, p.horizontal.second, p.diagonal.first,
+                                   p.diagonal.second);
+            selectGenerators(); // in case they don't fit the scale size
+        };
+        selectGenerators();
+
+        addAndMakeVisible(periodLabel);
+        periodLabel.setJustificationType(juce::Justification::left);
+        periodLabel.setColour(juce::Label::backgroundColourId, bg);
+        periodLabel.setColour(juce::Label::outlineColourId, ol);
+
+        addAndMakeVisible(periodBox);
+        for (int i = 0; i < lattices::scaledata::numPeriodPresets; ++i)
+        {
+            periodBox.addItem(lattices::scaledata::periodPresets[i].name, i + 1);
+        }
+        periodBox.setColour(juce::ComboBox::outlineColourId, ol);
+        periodBox.onChange = [this]
+        {
+            auto i = periodBox.getSelectedId() - 1;
+            if (i < 0)
+                return;
+            auto &p = lattices::scaledata::periodPresets[i];
+            proc->updatePeriod(p.ratio.first, p.ratio.second);
+            selectPeriod();
+        };
+        selectPeriod();
+
+        syntonicButton.setEnabled(syntonicAvailable());
+
+        addAndMakeVisible(lowPowerButton);
+        lowPowerButton.setClickingTogglesState(true);
+        lowPowerButton.setToggleState(proc->lowPower, juce::dontSendNotification);
+        lowPowerButton.onClick = [this] { proc->updateLowPower(lowPowerButton.getToggleState()); };
     }
 
     void paint(juce::Graphics &g) override
@@ -116,15 +201,35 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
         homeLabel.setBounds(10, 125, 70, 20);
         homeEditor.setBounds(80, 125, 30, 20);
 
-        channelLabel.setBounds(10, 150, 70, 20);
-        channelEditor.setBounds(80, 150, 30, 20);
+        axisLabel.setBounds(10, 150, 70, 20);
+        axisEditor.setBounds(80, 150, 30, 20);
+
+        channelLabel.setBounds(10, 175, 70, 20);
+        channelEditor.setBounds(80, 175, 30, 20);
+
+        sizeLabel.setBounds(10, 200, 55, 20);
+        sizeBox.setBounds(65, 200, 45, 20);
+
+        genLabel.setBounds(10, 225, 35, 20);
+        genBox.setBounds(45, 225, 65, 20);
+
+        periodLabel.setBounds(10, 250, 55, 20);
+        periodBox.setBounds(65, 250, 45, 20);
+
+        lowPowerButton.setBounds(10, 275, 100, 20);
     }
 
     void reset()
     {
         distEditor.setText(std::to_string(proc->maxDistance), false);
         homeEditor.setText(std::to_string(proc->homeCC), false);
+        axisEditor.setText(std::to_string(proc->axisCC), false);
         channelEditor.setText(std::to_string(proc->listenOnChannel), false);
+        sizeBox.setSelectedId(proc->scaleSize, juce::dontSendNotification);
+        selectGenerators();
+        selectPeriod();
+        syntonicButton.setEnabled(syntonicAvailable());
+        lowPowerButton.setToggleState(proc->lowPower, juce::dontSendNotification);
 
         if (proc->mode == LatticesProcessor::Syntonic)
         {
@@ -141,6 +246,7 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
 
     uint8_t priorChannel;
     uint8_t priorCC;
+    uint8_t priorAxisCC;
     uint16_t priorDistance;
 
     juce::Label distLabel{{}, "Max Distance"};
@@ -149,17 +255,98 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
     juce::Label homeLabel{{}, "Home CC"};
     juce::TextEditor homeEditor{"Home"};
 
+    juce::Label axisLabel{{}, "7/11 CC"};
+    juce::TextEditor axisEditor{"Axes"};
+
     juce::Label channelLabel{{}, "Channel"};
     juce::TextEditor channelEditor{"Channel"};
 
+    juce::Label sizeLabel{{}, "Notes"};
+    juce::ComboBox sizeBox{"Notes"};
+
+    juce::Label genLabel{{}, "Axes"};
+    juce::ComboBox genBox{"Axes"};
+
+    juce::Label periodLabel{{}, "Period"};
+    juce::ComboBox periodBox{"Period"};
+
     juce::TextButton duodeneButton{"Duodene"};
     juce::TextButton syntonicButton{"Syntonic"};
 
+    juce::TextButton lowPowerButton{"Low Power"};
+
     //    juce::Colour noColour{};
     juce::Colour bg{.475f, .5f, 0.2f, 1.f};
     juce::Colour ol{juce::Colours::ghostwhite};
     juce::Range<int> noRange{};
 
+    // the preset matching the processor's generators, if any
+    void selectGenerators()
+    {
+        auto &j = proc->jim;
+        int id{0};
+        for (int i = 0; i < lattices::scaledata::numGeneratorPresets; ++i)
+        {
+            auto &p = lattices::scaledata::generatorPresets[i];
+            if (p.horizontal == lattices::scaledata::frac_t{j.horizNum, j.horizDen} &&
+                p.diagonal == lattices::scaledata::frac_t{j.diagNum, j.diagDen})
+                id = i + 1;
+        }
+        genBox.setSelectedId(id, juce::dontSendNotification);
+    }
+
+    void selectPeriod()
+    {
+        auto &j = proc->jim;
+        int id{0};
+        for (int i = 0; i < lattices::scaledata::numPeriodPresets; ++i)
+        {
+            if (lattices::scaledata::periodPresets[i].ratio ==
+                lattices::scaledata::frac_t{j.periodNum, j.periodDen})
+                id = i + 1;
+        }
+        periodBox.setSelectedId(id, juce::dontSendNotification);
+    }
+
+    // A new size starts every visitor group over from the default, so ask first if
+    // there are any besides nobody
+    void changeSize(int size)
+    {
+        if (size == proc->scaleSize || proc->numVisitorGroups < 2)
+        {
+            proc->updateScaleSize(size);
+            return;
+        }
+
+        auto options = juce::MessageBoxOptions()
+                           .withIconType(juce::MessageBoxIconType::QuestionIcon)
+                           .withTitle("Notes")
+                           .withMessage("A different number of notes resets every visitor group "
+                                        "to the default scale.")
+                           .withButton("Change")
+                           .withButton("Cancel")
+                           .withAssociatedComponent(this);
+        juce::Component::SafePointer<SettingsComponent> safe{this};
+        juce::AlertWindow::showAsync(options,
+                                     [safe, size](int result)
+                                     {
+                                         if (!safe)
+                                             return;
+                                         if (result == 1)
+                                             safe->proc->updateScaleSize(size);
+                                         else
+                                             safe->sizeBox.setSelectedId(
+                                                 safe->proc->scaleSize, juce::dontSendNotification);
+                                     });
+    }
+
+    // the syntonic walk only exists for the Duodene
+    bool syntonicAvailable() const
+    {
+        return proc->scaleSize == 12 && proc->jim.hasDefaultGenerators() &&
+               proc->jim.hasOctavePeriod();
+    }
+
     void updateToggleState()
     {
         if (duodeneButton.getToggleState() == true)
@@ -194,6 +381,16 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
             return false;
         }
 
+        // the axis CCs only need room for four after the first
+        if (type == 3)
+        {
+            if (input < 1 || input > 124)
+            {
+                return true;
+            }
+            return false;
+        }
+
         if (input < 1 || input > 89)
         {
             return true;
@@ -211,16 +408,27 @@ struct SettingsComponent : public juce::Component // , juce::ToggleButton
 
         if (e == &homeEditor)
         {
-            if (rejectBadInput(digit))
+            // or if it runs into the axis CCs
+            if (rejectBadInput(digit) || !proc->updateMIDICC(digit))
             {
                 e->setText(std::to_string(priorCC));
                 return;
             }
 
-            proc->updateMIDICC(digit);
             priorCC = digit;
         }
 
+        if (e == &axisEditor)
+        {
+            if (rejectBadInput(digit, 3) || !proc->updateAxisCC(digit))
+            {
+                e->setText(std::to_string(priorAxisCC));
+                return;
+            }
+
+            priorAxisCC = digit;
+        }
+
         if (e == &channelEditor)
         {
             if (rejectBadInput(digit, 1))
@@ -24,14 +24,15 @@
 //==============================================================================
 struct VisitorsComponent : public juce::Component
 {
-    VisitorsComponent(LatticesProcessor &p) : proc(&p), Gradients(diameter / 2)
+    VisitorsComponent(LatticesProcessor &p)
+        : proc(&p), Gradients(diameter / 2, p.commaRegistry)
     {
         juce::Colour n{juce::Colours::transparentWhite};
         juce::Colour o{juce::Colours::ghostwhite.withAlpha(.15f)};
 
         circle.addEllipse(0, 0, diameter, diameter);
 
-        for (int i = 0; i < 7; ++i)
+        for (int i = 0; i < proc->commaRegistry.numOffered; ++i)
         {
             commaButtons.push_back(
                 std::make_unique<juce::ShapeButton>("option" + std::to_string(i), n, o, o));
@@ -53,14 +54,10 @@ struct VisitorsComponent : public juce::Component
         addAndMakeVisible(*rightButton);
         rightButton->onClick = [this] { scroll(true); };
 
-        for (int g = 0; g < proc->numVisitorGroups; ++g)
-        {
-            groups.push_back(std::make_unique<juce::TextButton>(std::to_string(g)));
-            addAndMakeVisible(*groups[g]);
-            groups[g]->setRadioGroupId(3);
-            groups[g]->onClick = [this] { selectGroup(); };
-            groups[g]->setClickingTogglesState(true);
-        }
+        groups = std::make_unique<lattices::render::GroupStrip>(thumbnails, p, 0, boxWidth,
+                                                                boxWidth);
+        addAndMakeVisible(*groups);
+        groups->onPick = [this](int g) { selectGroup(g); };
 
         addButton = std::make_unique<juce::TextButton>("Add");
         addAndMakeVisible(*addButton);
@@ -78,7 +75,7 @@ struct VisitorsComponent : public juce::Component
             setGroupData();
         };
 
-        groups[selectedGroup]->setToggleState(true, juce::dontSendNotification);
+        groups->setSelected(selectedGroup);
         commaButtons[1]->setToggleState(true, juce::dontSendNotification);
     }
 
@@ -88,40 +85,25 @@ struct VisitorsComponent : public juce::Component
         miniLattice->setBounds(1, diameter, b.getWidth() - 2, diameter * 4.5);
         miniLattice->setEnabled(proc->numVisitorGroups > 1 && selectedGroup != 0);
 
-        for (int i = 0; i < 7; ++i)
+        for (int i = 0; i < commaButtons.size(); ++i)
         {
-            commaButtons[i]->setEnabled(selectedGroup != 0);
+            // the layout may not have a place for some of our commas
+            commaButtons[i]->setEnabled(
+                selectedGroup != 0 && proc->latticeLayout.takes(proc->commaRegistry.offered[i]));
             commaButtons[i]->setBounds(5 * (1 + i) + diameter * i, diameter * 5 + 30 + 5, diameter,
                                        diameter);
         }
 
-        int num = proc->numVisitorGroups;
+        int stripWidth = std::max(b.getWidth() - 2 * (boxHeight + 5), 0);
+        groups->setBounds(5 + boxHeight, 5, stripWidth, boxHeight);
+        groups->update();
 
-        leftButton->setEnabled(num > 16 && scrollPosition != 0);
+        leftButton->setEnabled(groups->canScroll(false));
         leftButton->setBounds(5, 5, boxHeight, boxHeight);
-        rightButton->setEnabled(num > 16 && scrollPosition != 16 && scrollPosition < num - 17);
+        rightButton->setEnabled(groups->canScroll(true));
         rightButton->setBounds(b.getRight() - boxHeight - 5, 5, boxHeight, boxHeight);
 
-        int L = scrollPosition;
-        int R = L + 16;
-
-        for (int i = 0; i < proc->numVisitorGroups; ++i)
-        {
-            if (i >= L && i <= R)
-            {
-                groups[i]->setEnabled(true);
-                groups[i]->setVisible(true);
-                groups[i]->setBounds(5 + boxHeight + boxWidth * (i - L), 5, boxWidth, boxHeight);
-            }
-            else
-            {
-                groups[i]->setEnabled(false);
-                groups[i]->setVisible(false);
-            }
-        }
-
         addButton->setBounds(5, diameter + 5, 50, 25);
-        addButton->setEnabled(proc->numVisitorGroups < 33);
         deleteButton->setBounds(60, diameter + 5, 50, 25);
         deleteButton->setEnabled(proc->numVisitorGroups > 1 && selectedGroup != 0);
         resetButton->setBounds(5, diameter + 35, 50, 25);
@@ -156,19 +138,27 @@ struct VisitorsComponent : public juce::Component
 
         if (selectedGroup != 0)
         {
-            for (int i = 0; i < 7; ++i)
+            auto &reg = proc->commaRegistry;
+            for (int i = 0; i < commaButtons.size(); ++i)
             {
                 int left2 = 5.f * (1 + i) + diameter * i;
+                int c = reg.offered[i];
 
                 g.setColour(juce::Colours::black);
                 g.fillEllipse(left2, diameter * 5 + 30 + 5, diameter, diameter);
 
-                g.setGradientFill(Gradients.commaGrad(i, left2 + diameter / 2));
+                g.setGradientFill(Gradients.commaGrad(c, left2 + diameter / 2));
+                g.setOpacity(commaButtons[i]->isEnabled() ? 1.f : .3f);
                 g.fillEllipse(left2, diameter * 5 + 30 + 5, diameter, diameter);
 
+                // the row comma is whatever the diagonal makes it, not always the syntonic
+                juce::String label{reg.labels[c].data()};
+                if (c == lattices::scaledata::syntonic)
+                    label = juce::String(proc->latticeLayout.rowPrime);
+
                 g.setColour(juce::Colours::white);
                 g.setFont(stoke);
-                g.drawFittedText(names[i], left2 + 2, diameter * 5 + 2 + 30 + 5, diameter - 4,
+                g.drawFittedText(label, left2 + 2, diameter * 5 + 2 + 30 + 5, diameter - 4,
                                  diameter - 4, juce::Justification::centred, 1, .05f);
 
                 if (commaButtons[i]->getToggleState())
@@ -182,35 +172,23 @@ struct VisitorsComponent : public juce::Component
 
     void reset()
     {
-        groups.clear();
+        selectedGroup = proc->getCurrentVisitorGroupIndex();
 
-        for (int g = 0; g < proc->numVisitorGroups; ++g)
+        // the scale may have changed size under us
+        if (selectedNote >= proc->currentVisitors->numDegrees)
         {
-            groups.push_back(std::make_unique<juce::TextButton>(std::to_string(g)));
-            addAndMakeVisible(*groups[g]);
-            groups[g]->setRadioGroupId(3);
-            groups[g]->onClick = [this] { selectGroup(); };
-            groups[g]->setClickingTogglesState(true);
+            selectedNote = 0;
+            miniLattice->selectedDegree = 0;
         }
 
-        for (int i = 0; i < proc->numVisitorGroups; ++i)
-        {
-            if (proc->currentVisitors == &proc->visitorGroups[i])
-            {
-                selectedGroup = i;
-                break;
-            }
-        }
-
-        groups[selectedGroup]->setToggleState(true, juce::sendNotification);
+        groups->setSelected(selectedGroup);
         setGroupData();
     }
 
     void selectNote(int n)
     {
         selectedNote = n;
-        commaButtons[proc->currentVisitors->CC[n].nameIndex]->setToggleState(
-            true, juce::sendNotification);
+        toggleCommaButton();
         miniLattice->selectedDegree = n;
         repaint();
     }
@@ -231,9 +209,9 @@ struct VisitorsComponent : public juce::Component
 
     juce::Font stoke{juce::FontOptions(Stoke).withPointHeight(radius)};
 
-    std::array<std::string, 7> names = {"3", "5", "7", "11", "13", "17", "19"};
-
-    std::vector<std::unique_ptr<juce::TextButton>> groups;
+    // what each group does, pictured on its button
+    lattices::render::GroupThumbnails thumbnails{*proc, boxWidth, boxHeight};
+    std::unique_ptr<lattices::render::GroupStrip> groups;
 
     std::unique_ptr<juce::TextButton> deleteButton;
     std::unique_ptr<juce::TextButton> resetButton;
@@ -242,8 +220,6 @@ struct VisitorsComponent : public juce::Component
     std::unique_ptr<juce::TextButton> leftButton;
     std::unique_ptr<juce::TextButton> rightButton;
 
-    uint8_t scrollPosition{0};
-
     using lattice_t = SmallLatticeComponent<VisitorsComponent>;
     std::unique_ptr<lattice_t> miniLattice;
 
@@ -257,59 +233,48 @@ struct VisitorsComponent : public juce::Component
 
     void setGroupData()
     {
-        commaButtons[proc->currentVisitors->CC[selectedNote].nameIndex]->setToggleState(
-            true, juce::sendNotification);
+        toggleCommaButton();
 
         resized();
         repaint();
     }
 
+    // the selected note's comma, or the first button if the menu doesn't offer it
+    void toggleCommaButton()
+    {
+        auto b = proc->commaRegistry.buttonOf[proc->currentVisitors->CC[selectedNote].nameIndex];
+        commaButtons[std::max(b, 0)]->setToggleState(true, juce::sendNotification);
+    }
+
     void selectComma()
     {
         if (selectedGroup == 0)
             return;
 
-        for (int i = 0; i < 7; ++i)
+        for (int i = 0; i < commaButtons.size(); ++i)
         {
             if (commaButtons[i]->getToggleState())
             {
-                proc->updateVisitor(selectedNote, i);
+                proc->updateVisitor(selectedNote, proc->commaRegistry.offered[i]);
                 repaint();
                 break;
             }
         }
     }
 
-    void selectGroup()
+    void selectGroup(int g)
     {
-        for (int i = 0; i < proc->numVisitorGroups; ++i)
-        {
-            if (groups[i]->getToggleState())
-            {
-                selectedGroup = i;
-                proc->selectVisitorGroup(i);
-
-                if (selectedGroup > 16 + scrollPosition)
-                    scrollPosition = selectedGroup - 16;
-                break;
-            }
-        }
+        selectedGroup = g;
+        proc->selectVisitorGroup(g);
+        groups->setSelected(g);
         setGroupData();
     }
 
     void newGroup()
     {
+        // it's selected in the processor as soon as it's made
         if (proc->newVisitorGroup())
-        {
-            int newidx = groups.size();
-            groups.push_back(std::make_unique<juce::TextButton>(std::to_string(newidx)));
-            addAndMakeVisible(*groups[newidx]);
-            groups[newidx]->setRadioGroupId(3);
-            groups[newidx]->onClick = [this] { selectGroup(); };
-            groups[newidx]->setClickingTogglesState(true);
-            groups[newidx]->setToggleState(true, juce::sendNotification);
-            selectGroup();
-        }
+            selectGroup(proc->getCurrentVisitorGroupIndex());
     }
 
     void deleteGroup()
@@ -318,46 +283,13 @@ struct VisitorsComponent : public juce::Component
             return;
 
         proc->deleteVisitorGroup(selectedGroup);
-
-        for (int i = selectedGroup; i < groups.size(); ++i)
-        {
-            groups[i]->setButtonText(std::to_string(i - 1));
-        }
-        groups.erase(groups.begin() + selectedGroup);
-
-        if (scrollPosition != 0)
-        {
-            scrollPosition--;
-        }
-        groups[selectedGroup - 1]->setToggleState(true, juce::sendNotification);
-        selectGroup();
+        selectGroup(selectedGroup - 1);
     }
 
+    // a strip's worth either way, the selected group stays as it is
     void scroll(bool right)
     {
-        if (right)
-        {
-            scrollPosition++;
-        }
-        else
-        {
-            scrollPosition--;
-        }
-
-        int L = scrollPosition;
-        int R = L + 16;
-
-        if (selectedGroup < L)
-        {
-            groups[selectedGroup + 1]->setToggleState(true, juce::sendNotification);
-            selectGroup();
-        }
-        else if (selectedGroup > R)
-        {
-            groups[selectedGroup - 1]->setToggleState(true, juce::sendNotification);
-            selectGroup();
-        }
-        else
-            resized();
+        groups->page(right);
+        resized();
     }
 };
@@ -21,13 +21,14 @@
 #include "melatonin_inspector/melatonin_inspector.h"
 
 //==============================================================================
-struct EveryComponent : public juce::Component, juce::MultiTimer
+struct EveryComponent : public juce::Component,
+                        private lattices::ChangeBus::Subscriber,
+                        private juce::ComponentListener
 {
     EveryComponent(LatticesProcessor &p, int w, int h) : processor(p), width(w), height(h)
     {
         latticeComponent = std::make_unique<LatticeComponent>(p);
         addAndMakeVisible(*latticeComponent);
-        latticeComponent->setBufferedToImage(true);
 
         warningComponent = std::make_unique<MTSWarningComponent>(p);
         addAndMakeVisible(*warningComponent);
@@ -36,22 +37,30 @@ struct EveryComponent : public juce::Component, juce::MultiTimer
         addAndMakeVisible(*menuComponent);
         menuComponent->setBounds(0, 0, this->getLocalBounds().getWidth(), 30);
 
+        // opening and closing these changes how much room the menus need
+        menuComponent->visC->addComponentListener(this);
+        menuComponent->settingsC->addComponentListener(this);
+        processor.changes.subscribe(lattices::ChangeBus::StateLoaded, this);
+
         if (p.registeredMTS)
         {
             inited = true;
-            startTimer(0, 5);
             resized();
         }
         else
         {
             latticeComponent->setEnabled(false);
             menuComponent->setVisible(false);
-            startTimer(1, 50);
+            processor.changes.subscribe(lattices::ChangeBus::Registration, this);
         }
     }
 
     ~EveryComponent() override
     {
+        processor.changes.unsubscribe(this);
+        menuComponent->visC->removeComponentListener(this);
+        menuComponent->settingsC->removeComponentListener(this);
+
         if (processor.stopVisitorChanges)
         {
             processor.preventVisitorChangesFromProcessor(false);
@@ -72,7 +81,7 @@ struct EveryComponent : public juce::Component, juce::MultiTimer
             }
             else if (setOpen)
             {
-                h = 240;
+                h = 340;
             }
 
             menuComponent->setBounds(0, 0, b.getWidth(), h);
@@ -98,44 +107,47 @@ struct EveryComponent : public juce::Component, juce::MultiTimer
 
     bool inited{false};
 
+    // the processor's changes reach the editor once a frame, see ChangeBus.h
+    juce::VBlankAttachment deliverChanges{this, [this] { processor.changes.deliver(); }};
+
     bool setOpen{false};
     bool visOpen{false};
-    void timerCallback(int timerID) override
+    void changed(lattices::ChangeBus::Topic topic) override
     {
-        if (timerID == 1)
+        if (topic == lattices::ChangeBus::Registration && !inited)
         {
-            if (processor.registeredMTS)
-            {
-                warningComponent->setVisible(false);
-                warningComponent->setEnabled(false);
-                stopTimer(1);
-                latticeComponent->setEnabled(true);
-                menuComponent->setVisible(true);
-                inited = true;
-                startTimer(0, 5);
-                resized();
-            }
+            warningComponent->setVisible(false);
+            warningComponent->setEnabled(false);
+            latticeComponent->setEnabled(true);
+            menuComponent->setVisible(true);
+            inited = true;
+            resized();
+            menusChanged();
         }
 
-        if (timerID == 0)
+        if (topic == lattices::ChangeBus::StateLoaded && inited)
         {
-            if (processor.loadedState)
-            {
-                menuComponent->resetAll();
-                processor.loadedState = false;
-            }
+            menuComponent->resetAll();
+        }
+    }
 
-            bool edvi = menuComponent->visC->isVisible();
-            bool edse = menuComponent->settingsC->isVisible();
+    void componentVisibilityChanged(juce::Component &) override
+    {
+        if (inited)
+            menusChanged();
+    }
 
-            if (edvi != visOpen || edse != setOpen)
-            {
-                visOpen = edvi;
-                setOpen = edse;
-                resized();
-                latticeComponent->setEnabled(!edvi && !edse);
-                latticeComponent->repaint();
-            }
+    void menusChanged()
+    {
+        bool edvi = menuComponent->visC->isVisible();
+        bool edse = menuComponent->settingsC->isVisible();
+
+        if (edvi != visOpen || edse != setOpen)
+        {
+            visOpen = edvi;
+            setOpen = edse;
+            resized();
+            latticeComponent->setEnabled(!edvi && !edse);
         }
     }
 };
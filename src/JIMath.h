@@ -12,17 +12,82 @@
 #ifndef LATTICES_JIMATH_H
 #define LATTICES_JIMATH_H
 
-#include <utility>
-#include <string>
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <utility>
 
 struct JIMath
 {
     uint64_t horizNum{3}, horizDen{2}, diagNum{5}, diagDen{4};
+    uint64_t periodNum{2}, periodDen{1}; // the interval of equivalence
 
     JIMath(uint64_t horizN = 3, uint64_t horizD = 2, uint64_t diagN = 5, uint64_t diagD = 4)
-        : horizNum(horizN), horizDen(horizD), diagNum(diagN), diagDen(diagD)
     {
+        setGenerators(horizN, horizD, diagN, diagD);
+    }
+
+    // The ratios one step east and one step north on the lattice.
+    // Everything derived from them is rebuilt here, rather than per cell.
+    void setGenerators(uint64_t horizN, uint64_t horizD, uint64_t diagN, uint64_t diagD)
+    {
+        horizNum = horizN;
+        horizDen = horizD;
+        diagNum = diagN;
+        diagDen = diagD;
+
+        horizSpelling = spell(horizNum, horizDen);
+        diagSpelling = spell(diagNum, diagDen);
+
+        fillPowers(horizPowers, horizNum, horizDen);
+        fillPowers(diagPowers, diagNum, diagDen);
+    }
+
+    // The ratio everything is reduced by. An octave unless we say otherwise,
+    // 3/1 for a Bohlen-Pierce tritave, or anything else above 1/1.
+    void setPeriod(uint64_t num, uint64_t denom)
+    {
+        periodNum = num;
+        periodDen = denom;
+
+        fillPowers(horizPowers, horizNum, horizDen);
+        fillPowers(diagPowers, diagNum, diagDen);
+    }
+
+    bool hasDefaultGenerators() const
+    {
+        return horizNum == 3 && horizDen == 2 && diagNum == 5 && diagDen == 4;
+    }
+
+    bool hasOctavePeriod() const { return periodNum == 2 && periodDen == 1; }
+
+    // How a ratio is spelled: the pythagorean note it sits on, counted in fifths
+    // from the root, and how many syntonic, septimal and undecimal commas off it is.
+    // 5/4 for example is E, four fifths up, one syntonic comma flat.
+    struct spelling_t
+    {
+        int fifths{0}, syntonic{0}, septimal{0}, undecimal{0};
+    };
+    spelling_t horizSpelling{1, 0, 0, 0}, diagSpelling{4, 1, 0, 0};
+
+    // The ratio of the cell h steps east and d steps north of the root, period reduced.
+    std::pair<uint64_t, uint64_t> cellRatio(int h, int d) const
+    {
+        if (std::abs(h) <= reach && std::abs(d) <= reach)
+        {
+            auto [hn, hd] = horizPowers[h + reach];
+            auto [dn, dd] = diagPowers[d + reach];
+            return reduced(hn * dn, hd * dd);
+        }
+
+        uint64_t n{1}, dn{1};
+        stepRatio(n, dn, horizNum, horizDen, h);
+        stepRatio(n, dn, diagNum, diagDen, d);
+        return {n, dn};
     }
 
     // Maybe move these to the tuning library on Tones one day?
@@ -55,15 +120,18 @@ struct JIMath
         return {nR, dR};
     }
 
+    // Named for the octave, but reduces by whatever the period is
     inline void octaveReduceRatio(uint64_t &num, uint64_t &denom)
     {
         while (num < denom)
         {
-            num *= 2;
+            num *= periodNum;
+            denom *= periodDen;
         }
-        while (num > denom * 2)
+        while (num * periodDen > denom * periodNum)
         {
-            denom *= 2;
+            num *= periodDen;
+            denom *= periodNum;
         }
     }
 
@@ -117,6 +185,59 @@ struct JIMath
         octaveReduceRatio(n, d);
         ratioToMonzo(n, d, m);
     }
+
+  private:
+    // Nearby cells come straight from these tables, further ones get stepped to.
+    // Twelve steps of both generators still fit comfortably in 64 bits.
+    static constexpr int reach{12};
+    typedef std::array<std::pair<uint64_t, uint64_t>, 2 * reach + 1> powers_t;
+    powers_t horizPowers{}, diagPowers{};
+
+    // into [1, period), lowest terms
+    std::pair<uint64_t, uint64_t> reduced(uint64_t n, uint64_t d) const
+    {
+        while (n < d)
+        {
+            n *= periodNum;
+            d *= periodDen;
+        }
+        while (n * periodDen >= d * periodNum)
+        {
+            n *= periodDen;
+            d *= periodNum;
+        }
+        auto g = std::gcd(n, d);
+        return {n / g, d / g};
+    }
+
+    void stepRatio(uint64_t &n, uint64_t &d, uint64_t gn, uint64_t gd, int steps) const
+    {
+        for (; steps > 0; --steps)
+        {
+            std::tie(n, d) = reduced(n * gn, d * gd);
+        }
+        for (; steps < 0; ++steps)
+        {
+            std::tie(n, d) = reduced(n * gd, d * gn);
+        }
+    }
+
+    void fillPowers(powers_t &powers, uint64_t gn, uint64_t gd)
+    {
+        for (int p = -reach; p <= reach; ++p)
+        {
+            uint64_t n{1}, d{1};
+            stepRatio(n, d, gn, gd, p);
+            powers[p + reach] = {n, d};
+        }
+    }
+
+    spelling_t spell(uint64_t num, uint64_t denom)
+    {
+        monzo m{};
+        ratioToMonzo(num, denom, m);
+        return {m[1] + 4 * m[2] - 2 * m[3] - m[4], m[2], m[3], m[4]};
+    }
 };
 
 #endif // JI_MTS_SOURCE_JIMATH_H
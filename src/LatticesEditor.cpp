@@ -11,12 +11,31 @@
 
 #include "LatticesProcessor.h"
 #include "LatticesEditor.h"
+#include "AllocationCounter.h"
+
+#if LATTICES_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+
+// Counting every allocation, see AllocationCounter.h
+void *operator new(std::size_t size)
+{
+    ++lattices::allocations::count;
+    if (auto *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+#endif
 
 //==============================================================================
 LatticesEditor::LatticesEditor(LatticesProcessor &p) : juce::AudioProcessorEditor(&p), processor(p)
 {
     everyComponent = std::make_unique<EveryComponent>(p, width, height);
-    everyComponent->setBufferedToImage(true);
     everyComponent->setBounds(0, 0, width, height);
     addAndMakeVisible(*everyComponent);
 
@@ -12,6 +12,7 @@
 #include "LatticesProcessor.h"
 #include "LatticesEditor.h"
 #include "libMTSMaster.h"
+#include "Components/LatticeGeometry.h"
 
 //==============================================================================
 LatticesProcessor::LatticesProcessor()
@@ -24,7 +25,10 @@ LatticesProcessor::LatticesProcessor()
                      new juce::AudioParameterFloat("px", "X Position", r, 0.5, distanceReadoutX));
     addParameter(yParam =
                      new juce::AudioParameterFloat("py", "Y Position", r, 0.5, distanceReadoutY));
-    addParameter(vParam = new juce::AudioParameterFloat("pv", "Visitors", r, 0, visitorsReadout));
+    // This was "pv", a float scaled by however many groups there were. The new ID
+    // keeps old automation from calling up some other group, see setStateInformation().
+    addParameter(vParam = new juce::AudioParameterInt("pvg", "Visitors", 0, maxVisitorGroups - 1,
+                                                      0, visitorsReadout));
     addParameter(fParam = new juce::AudioParameterFloat(
                      "pf", "Reference Frequency", r, toFreqParam(261.6255653), frequencyReadout));
 
@@ -33,8 +37,18 @@ LatticesProcessor::LatticesProcessor()
     vParam->addListener(this);
     fParam->addListener(this);
 
+    for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+    {
+        auto p = std::to_string(lattices::scaledata::extraAxes[a].num);
+        addParameter(axisParams[a] = new juce::AudioParameterFloat(
+                         "p" + p, p + "-Limit Position", r, 0.5, axisReadout(a)));
+        axisParams[a]->addListener(this);
+    }
+
+    loadCommaRegistry();
+
     numVisitorGroups = 1;
-    lattices::scaledata::ScaleData dg{"Nobody Here"};
+    lattices::scaledata::ScaleData dg{"Nobody Here", nullptr, latticeLayout, commaRegistry};
     visitorGroups.push_back(std::move(dg));
     hold.emplace_back(false);
     wait.emplace_back(false);
@@ -61,6 +75,8 @@ LatticesProcessor::~LatticesProcessor()
     yParam->removeListener(this);
     vParam->removeListener(this);
     fParam->removeListener(this);
+    for (auto *a : axisParams)
+        a->removeListener(this);
 
     if (registeredMTS)
         MTS_DeregisterMaster();
@@ -92,6 +108,7 @@ void LatticesProcessor::getStateInformation(juce::MemoryBlock &destData)
     xml->setAttribute("SavedMode", static_cast<int>(mode));
 
     xml->setAttribute("cc", homeCC);
+    xml->setAttribute("acc", axisCC);
     xml->setAttribute("channel", listenOnChannel);
 
     int rn = originalRefNote;
@@ -107,7 +124,19 @@ void LatticesProcessor::getStateInformation(juce::MemoryBlock &destData)
     xml->setAttribute("vp", V);
     xml->setAttribute("freq", F);
 
+    for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+    {
+        xml->setAttribute("ap" + std::to_string(a), fromXYParam(axisParams[a]->get()));
+    }
+
     xml->setAttribute("nvg", numVisitorGroups);
+    xml->setAttribute("ns", scaleSize);
+    xml->setAttribute("hn", static_cast<int>(jim.horizNum));
+    xml->setAttribute("hd", static_cast<int>(jim.horizDen));
+    xml->setAttribute("dn", static_cast<int>(jim.diagNum));
+    xml->setAttribute("dd", static_cast<int>(jim.diagDen));
+    xml->setAttribute("pn", static_cast<int>(jim.periodNum));
+    xml->setAttribute("pd", static_cast<int>(jim.periodDen));
 
     if (numVisitorGroups > 1) // no need to store number 0 since it's the default
     {
@@ -120,7 +149,7 @@ void LatticesProcessor::getStateInformation(juce::MemoryBlock &destData)
 
             xml->setAttribute(n, name);
 
-            for (int d = 0; d < 12; ++d)
+            for (int d = 0; d < visitorGroups[v].numDegrees; ++d)
             {
                 auto b = vs + juce::String("idx_") + std::to_string(d);
                 int i = visitorGroups[v].CC[d].nameIndex;
@@ -130,6 +159,7 @@ void LatticesProcessor::getStateInformation(juce::MemoryBlock &destData)
     }
 
     xml->setAttribute("md", maxDistance);
+    xml->setAttribute("lp", static_cast<int>(lowPower));
 
     copyXmlToBinary(*xml, destData);
 }
@@ -154,6 +184,11 @@ void LatticesProcessor::setStateInformation(const void *data, int sizeInBytes)
             }
 
             homeCC = xmlState->getIntAttribute("cc", 5);
+            axisCC = xmlState->getIntAttribute("acc", 102);
+            if (ccsOverlap(homeCC, axisCC)) // move the axes out of the way
+            {
+                axisCC = (homeCC + 5 <= 102) ? 102 : homeCC - numAxisCCs;
+            }
             listenOnChannel = xmlState->getIntAttribute("channel", 1);
 
             originalRefNote = xmlState->getIntAttribute("note", 0);
@@ -210,11 +245,41 @@ void LatticesProcessor::setStateInformation(const void *data, int sizeInBytes)
             }
 
             maxDistance = xmlState->getIntAttribute("md", 24);
+            lowPower = xmlState->getBoolAttribute("lp", false);
 
-            numVisitorGroups = xmlState->getIntAttribute("nvg", 1);
+            numVisitorGroups =
+                juce::jlimit(1, maxVisitorGroups, xmlState->getIntAttribute("nvg", 1));
+
+            int ns = xmlState->getIntAttribute("ns", 12);
+            scaleSize = lattices::scaledata::isSupportedSize(ns) ? ns : 12;
+
+            uint64_t hn = xmlState->getIntAttribute("hn", 3);
+            uint64_t hd = xmlState->getIntAttribute("hd", 2);
+            uint64_t dn = xmlState->getIntAttribute("dn", 5);
+            uint64_t dd = xmlState->getIntAttribute("dd", 4);
+            uint64_t pn = xmlState->getIntAttribute("pn", 2);
+            uint64_t pd = xmlState->getIntAttribute("pd", 1);
+            if (lattices::scaledata::generatorsFit(scaleSize, {hn, hd}, {dn, dd}, {pn, pd}))
+            {
+                jim.setGenerators(hn, hd, dn, dd);
+                jim.setPeriod(pn, pd);
+            }
+            else
+            {
+                jim.setGenerators(3, 2, 5, 4);
+                jim.setPeriod(2, 1);
+            }
+
+            if (scaleSize != 12 || !jim.hasDefaultGenerators() || !jim.hasOctavePeriod())
+            {
+                mode = Duodene;
+            }
 
             visitorGroups.clear();
-            lattices::scaledata::ScaleData dg{"Nobody Here"};
+            visitorGroups.reserve(juce::jmax(numVisitorGroups, 1));
+            rebuildLayout();
+            lattices::scaledata::ScaleData dg{"Nobody Here", nullptr, latticeLayout,
+                                              commaRegistry};
             visitorGroups.push_back(std::move(dg));
 
             if (numVisitorGroups > 1)
@@ -226,13 +291,13 @@ void LatticesProcessor::setStateInformation(const void *data, int sizeInBytes)
 
                     juce::String jsn{xmlState->getStringAttribute(n)};
                     std::string name = jsn.toStdString();
-                    int vds[12]{};
-                    for (int d = 0; d < 12; ++d)
+                    int vds[lattices::scaledata::maxDegrees]{};
+                    for (int d = 0; d < scaleSize; ++d)
                     {
                         auto b = vs + juce::String("idx_") + std::to_string(d);
                         vds[d] = xmlState->getIntAttribute(b);
                     }
-                    lattices::scaledata::ScaleData ng{name, vds};
+                    lattices::scaledata::ScaleData ng{name, vds, latticeLayout, commaRegistry};
                     visitorGroups.push_back(std::move(ng));
                 }
             }
@@ -247,6 +312,8 @@ void LatticesProcessor::setStateInformation(const void *data, int sizeInBytes)
                 wait.emplace_back(false);
             }
 
+            // "vp" has always been the group's number rather than the parameter's value,
+            // so states saved with the old "pv" parameter carry over as they are
             int tv = xmlState->getIntAttribute("vp", 0);
             int tx = xmlState->getIntAttribute("xp", 0);
             int ty = xmlState->getIntAttribute("yp", 0);
@@ -272,8 +339,17 @@ void LatticesProcessor::setStateInformation(const void *data, int sizeInBytes)
             vParam->endChangeGesture();
             fParam->endChangeGesture();
 
-            loadedState = true;
-            changed = true;
+            for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+            {
+                int ta = xmlState->getIntAttribute("ap" + std::to_string(a), 0);
+                axisParams[a]->beginChangeGesture();
+                axisParams[a]->setValueNotifyingHost(toXYParam(ta));
+                axisParams[a]->endChangeGesture();
+            }
+
+            changes.publish(lattices::ChangeBus::StateLoaded);
+            changes.publish(lattices::ChangeBus::Tuning);
+            changes.publish(lattices::ChangeBus::Appearance);
 
             // no need for locate(); since paramChanged calls it
         }
@@ -309,7 +385,7 @@ void LatticesProcessor::respondToMidi(const juce::MidiMessage &m)
         auto num = m.getControllerNumber();
         auto val = m.getControllerValue();
 
-        int numCCs = 5 + numVisitorGroups - 1;
+        int numCCs = numHomeCCs();
 
         for (int i = 0; i < numCCs; ++i)
         {
@@ -327,6 +403,23 @@ void LatticesProcessor::respondToMidi(const juce::MidiMessage &m)
                 }
             }
         }
+
+        for (int i = 0; i < 2 * lattices::scaledata::numExtraAxes; ++i)
+        {
+            if (num == axisCC + i)
+            {
+                if (val == 127 && !axisHold[i])
+                {
+                    axisHold[i] = true;
+                }
+
+                if (val < 127 && axisHold[i] && axisWait[i])
+                {
+                    axisHold[i] = false;
+                    axisWait[i] = false;
+                }
+            }
+        }
     }
 }
 
@@ -340,6 +433,7 @@ void LatticesProcessor::timerCallback(int timerID)
             {
                 MTS_RegisterMaster();
                 registeredMTS = true;
+                changes.publish(lattices::ChangeBus::Registration);
                 std::cout << "registered OK" << std::endl;
                 stopTimer(0);
                 startTimer(1, 5);
@@ -354,6 +448,7 @@ void LatticesProcessor::timerCallback(int timerID)
             MTS_Reinitialize();
             MTS_RegisterMaster();
             registeredMTS = true;
+            changes.publish(lattices::ChangeBus::Registration);
             MTSreInit = false;
             std::cout << "registered OK" << std::endl;
             stopTimer(0);
@@ -364,7 +459,7 @@ void LatticesProcessor::timerCallback(int timerID)
 
     if (timerID == 1)
     {
-        for (int i = 0; i < 5 + numVisitorGroups - 1; ++i)
+        for (int i = 0; i < numHomeCCs(); ++i)
         {
             if (hold[i] && !wait[i])
             {
@@ -395,6 +490,15 @@ void LatticesProcessor::timerCallback(int timerID)
             }
         }
 
+        for (int i = 0; i < 2 * lattices::scaledata::numExtraAxes; ++i)
+        {
+            if (axisHold[i] && !axisWait[i])
+            {
+                shift(Up7 + i);
+                axisWait[i] = true;
+            }
+        }
+
         numClients = MTS_GetNumClients();
     }
 }
@@ -405,6 +509,8 @@ void LatticesProcessor::modeSwitch(int m)
     switch (m)
     {
     case Syntonic:
+        if (scaleSize != 12 || !jim.hasDefaultGenerators() || !jim.hasOctavePeriod())
+            break; // the syntonic walk is only defined for the Duodene
         mode = Syntonic;
         preventVisitorChangesFromProcessor(true);
         returnToOrigin();
@@ -419,11 +525,26 @@ void LatticesProcessor::modeSwitch(int m)
     }
 }
 
-void LatticesProcessor::updateMIDICC(int hCC)
+bool LatticesProcessor::updateMIDICC(int hCC)
 {
+    if (ccsOverlap(hCC, axisCC))
+        return false;
+
     homeCC = hCC;
 
     updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
+    return true;
+}
+
+bool LatticesProcessor::updateAxisCC(int aCC)
+{
+    if (ccsOverlap(homeCC, aCC))
+        return false;
+
+    axisCC = aCC;
+
+    updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
+    return true;
 }
 
 void LatticesProcessor::updateMIDIChannel(int C)
@@ -439,6 +560,7 @@ void LatticesProcessor::updateFreq(double f)
     fParam->setValueNotifyingHost(toFreqParam(f));
     originalRefFreq = f;
     fParam->endChangeGesture();
+    changes.publish(lattices::ChangeBus::Origin);
 }
 
 double LatticesProcessor::updateRoot(int r)
@@ -451,6 +573,7 @@ double LatticesProcessor::updateRoot(int r)
     fParam->setValueNotifyingHost(toFreqParam(nf));
     originalRefFreq = nf;
     fParam->endChangeGesture();
+    changes.publish(lattices::ChangeBus::Origin);
 
     switch (r)
     {
@@ -518,17 +641,181 @@ void LatticesProcessor::updateDistance(int dist)
     updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
 }
 
-bool LatticesProcessor::newVisitorGroup()
+void LatticesProcessor::updateLowPower(bool on)
+{
+    if (on == lowPower)
+        return;
+
+    lowPower = on;
+    changes.publish(lattices::ChangeBus::Appearance);
+    updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
+}
+
+void LatticesProcessor::updateScaleSize(int n)
+{
+    if (n == scaleSize || !lattices::scaledata::isSupportedSize(n))
+        return;
+
+    scaleSize = n;
+    if (!lattices::scaledata::generatorsFit(n, {jim.horizNum, jim.horizDen},
+                                            {jim.diagNum, jim.diagDen},
+                                            {jim.periodNum, jim.periodDen}))
+    {
+        jim.setGenerators(3, 2, 5, 4);
+        jim.setPeriod(2, 1);
+    }
+    relayout();
+}
+
+void LatticesProcessor::updateGenerators(uint64_t hN, uint64_t hD, uint64_t dN, uint64_t dD)
+{
+    if (hN == jim.horizNum && hD == jim.horizDen && dN == jim.diagNum && dD == jim.diagDen)
+        return;
+    if (!lattices::scaledata::generatorsFit(scaleSize, {hN, hD}, {dN, dD},
+                                            {jim.periodNum, jim.periodDen}))
+        return;
+
+    jim.setGenerators(hN, hD, dN, dD);
+    relayout();
+}
+
+void LatticesProcessor::updatePeriod(uint64_t pN, uint64_t pD)
+{
+    if (pN == jim.periodNum && pD == jim.periodDen)
+        return;
+    if (!lattices::scaledata::generatorsFit(scaleSize, {jim.horizNum, jim.horizDen},
+                                            {jim.diagNum, jim.diagDen}, {pN, pD}))
+        return;
+
+    jim.setPeriod(pN, pD);
+    relayout();
+}
+
+// After the size, generators or period changed: lay everything out again and
+// start over from the origin, since where we were may not be a place any more
+void LatticesProcessor::relayout()
 {
+    rebuildLayout();
+
     if (mode == Syntonic)
-        return false;
-    if (visitorGroups.size() > 32) // > 32 because the 0th doesn't count
+    {
+        modeSwitch(Duodene);
+    }
+    else
+    {
+        returnToOrigin();
+    }
+
+    // the menus need to pick up the new layout, same as after loading a state
+    changes.publish(lattices::ChangeBus::StateLoaded);
+    updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
+}
+
+// Visitor groups keep their commas if the size stayed, minus any the new layout
+// has no place for. The first group is nobody, so it's whatever the layout's default is.
+void LatticesProcessor::rebuildLayout()
+{
+    latticeLayout = lattices::scaledata::buildLayout(scaleSize, {jim.horizNum, jim.horizDen},
+                                                     {jim.diagNum, jim.diagDen},
+                                                     {jim.periodNum, jim.periodDen});
+    for (auto &vg : visitorGroups)
+    {
+        vg.setLayout(latticeLayout);
+    }
+    if (!visitorGroups.empty())
+    {
+        visitorGroups[0].resetToDefault();
+    }
+}
+
+// User commas live in Lattices/commas.json in the user's application data folder,
+// as a list of objects like this one, where only the ratio is required:
+//
+//   {"ratio": "1053/1024", "offset": [-4, 1], "label": "13/8",
+//    "major": "^", "minor": "v", "colour": "ff8a2be2", "colourTo": "408a2be2"}
+//
+// The ratio is what an east (major) degree gets multiplied by, and the offset is
+// where that moves it on the lattice. They're appended to ours in file order,
+// and read once, here.
+void LatticesProcessor::loadCommaRegistry()
+{
+    commaRegistry = lattices::scaledata::builtInCommas;
+
+    auto file = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                    .getChildFile("Lattices")
+                    .getChildFile("commas.json");
+    if (!file.existsAsFile())
+        return;
+
+    auto json = juce::JSON::parse(file.loadFileAsString());
+    if (!json.isArray())
+    {
+        std::cout << "commas.json should hold a list of commas" << std::endl;
+        return;
+    }
+
+    for (const auto &entry : json)
+    {
+        auto ratio = entry["ratio"].toString();
+        auto n = ratio.upToFirstOccurrenceOf("/", false, false).getLargeIntValue();
+        auto d = ratio.fromFirstOccurrenceOf("/", false, false).getLargeIntValue();
+        if (n <= 0 || d <= 0 || n == d)
+            continue;
+        auto g = std::gcd(n, d);
+        lattices::scaledata::frac_t f{static_cast<uint64_t>(n / g), static_cast<uint64_t>(d / g)};
+
+        lattices::scaledata::coord_t offset{-4, 1};
+        auto o = entry["offset"];
+        if (o.isArray() && o.size() == 2)
+            offset = {static_cast<int>(o[0]), static_cast<int>(o[1])};
+
+        auto label = entry["label"].toString();
+        if (label.isEmpty())
+            label = ratio;
+
+        // too long for the menu button or the note names, and cutting it could leave
+        // half a character, so it's skipped like any other comma that won't do
+        auto major = entry["major"].toString();
+        auto minor = entry["minor"].toString();
+        if (!lattices::scaledata::glyphFits(label.toRawUTF8()) ||
+            !lattices::scaledata::glyphFits(major.toRawUTF8()) ||
+            !lattices::scaledata::glyphFits(minor.toRawUTF8()))
+        {
+            std::cout << "skipping " << ratio.toRawUTF8() << " in commas.json, its label or "
+                      << "accidentals are longer than "
+                      << lattices::scaledata::glyph_t{}.size() - 1 << " bytes" << std::endl;
+            continue;
+        }
+
+        auto colour = [&entry](const char *key) -> uint32_t
+        {
+            auto c = entry[key].toString();
+            return c.isEmpty() ? 0 : juce::Colour::fromString(c).getARGB();
+        };
+
+        if (!commaRegistry.add({commaRegistry.size, f, offset}, label.toRawUTF8(),
+                               major.toRawUTF8(), minor.toRawUTF8(), true, colour("colour"),
+                               colour("colourTo")))
+        {
+            std::cout << "only room for " << lattices::scaledata::maxUserCommas
+                      << " commas in commas.json" << std::endl;
+            break;
+        }
+    }
+}
+
+bool LatticesProcessor::newVisitorGroup()
+{
+    if (mode == Syntonic || numVisitorGroups >= maxVisitorGroups)
         return false;
 
     auto name = std::to_string(numVisitorGroups);
 
-    lattices::scaledata::ScaleData ng{name};
+    // growing may move every group, the current one included
+    int current = getCurrentVisitorGroupIndex();
+    lattices::scaledata::ScaleData ng{name, nullptr, latticeLayout, commaRegistry};
     visitorGroups.push_back(std::move(ng));
+    currentVisitors = &visitorGroups[current];
     // probably not necessary since process returns early if the visitors
     // editor is open, but let's do it anyway.
     std::lock_guard lock(visLock);
@@ -560,6 +847,7 @@ void LatticesProcessor::deleteVisitorGroup(int idx)
     hold.pop_back();
     wait.pop_back();
     --numVisitorGroups;
+    changes.publish(lattices::ChangeBus::Visitors);
 
     locate();
 }
@@ -569,6 +857,7 @@ void LatticesProcessor::selectVisitorGroup(int g)
         return;
 
     currentVisitors = &visitorGroups[g];
+    changes.publish(lattices::ChangeBus::Visitors);
     locate();
 }
 void LatticesProcessor::selectVisitorGroup(int g, bool toggle)
@@ -612,7 +901,7 @@ void LatticesProcessor::preventVisitorChangesFromProcessor(bool prevent)
 }
 void LatticesProcessor::updateVisitor(int d, int v)
 {
-    currentVisitors->setDegree(d, static_cast<lattices::scaledata::CommaNames>(v));
+    currentVisitors->setDegree(d, v);
     updateDegreeCoord(d);
     locate();
 }
@@ -630,8 +919,12 @@ void LatticesProcessor::updateSyntonicCoord(int d)
 }
 void LatticesProcessor::updateAllCoords()
 {
+    lattices::scaledata::coordN_t plane{};
+    int numDegrees = scaleSize;
+
     if (mode == Syntonic)
     {
+        numDegrees = 12;
         for (int d = 0; d < 12; ++d)
         {
             updateSyntonicCoord(d);
@@ -639,11 +932,22 @@ void LatticesProcessor::updateAllCoords()
     }
     else
     {
-        for (int d = 0; d < 12; ++d)
+        for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+        {
+            plane.setAxis(a, positionExtra[a]);
+        }
+        for (int d = 0; d < scaleSize; ++d)
         {
             updateDegreeCoord(d);
         }
     }
+
+    activePlane = plane.extra;
+    activeCells.clear();
+    for (int d = 0; d < numDegrees; ++d)
+    {
+        activeCells.insert({coOrds[d].first, coOrds[d].second, activePlane}, d);
+    }
 }
 
 void LatticesProcessor::returnToOrigin()
@@ -662,6 +966,12 @@ void LatticesProcessor::returnToOrigin()
     xParam->beginChangeGesture();
     xParam->setValueNotifyingHost(0.5);
     xParam->endChangeGesture();
+    for (auto *a : axisParams)
+    {
+        a->beginChangeGesture();
+        a->setValueNotifyingHost(0.5);
+        a->endChangeGesture();
+    }
     onOriginReturn = false;
     yParam->beginChangeGesture();
     yParam->setValueNotifyingHost(0.5);
@@ -676,20 +986,27 @@ void LatticesProcessor::parameterValueChanged(int parameterIndex, float newValue
     {
     case 0:
     case 1:
-        locate();
+        if (!jumping)
+            locate();
         break;
     case 2:
         if (!stopVisitorChanges)
         {
             int vis = fromVisitorParam(vParam->get());
             currentVisitors = &visitorGroups[vis];
+            changes.publish(lattices::ChangeBus::Visitors);
             locate();
         }
         break;
     case 3:
         originalRefFreq = fromFreqParam(fParam->get());
+        changes.publish(lattices::ChangeBus::Origin);
         updateTuning();
         break;
+    case 4:
+    case 5:
+        locate();
+        break;
     }
 }
 
@@ -727,15 +1044,59 @@ void LatticesProcessor::shift(int dir)
         yParam->setValueNotifyingHost(toXYParam(Y));
         yParam->endChangeGesture();
         break;
+    case Up7:
+    case Down7:
+    case Up11:
+    case Down11:
+    {
+        if (mode == Syntonic)
+            break;
+
+        auto *p = axisParams[(dir - Up7) / 2];
+        double A = fromXYParam(p->get());
+        A += ((dir - Up7) % 2 == 0) ? 1 : -1;
+        p->beginChangeGesture();
+        p->setValueNotifyingHost(toXYParam(A));
+        p->endChangeGesture();
+        break;
+    }
     };
 
     updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
 }
 
+// Moves by however far the root is from cell (x, y), from wherever we are
+// now, as one change of tuning rather than one per axis. Not in Syntonic mode,
+// where the root doesn't follow the position, see jumpTarget().
+void LatticesProcessor::jumpTo(int x, int y)
+{
+    auto to = lattices::geometry::jumpTarget(
+        {fromXYParam(xParam->get()), fromXYParam(yParam->get())}, coOrds[0], {x, y},
+        static_cast<int>(maxDistance), mode != Syntonic);
+    if (!to)
+        return;
+
+    jumping = true;
+    xParam->beginChangeGesture();
+    xParam->setValueNotifyingHost(toXYParam(to->first));
+    xParam->endChangeGesture();
+    yParam->beginChangeGesture();
+    yParam->setValueNotifyingHost(toXYParam(to->second));
+    yParam->endChangeGesture();
+    jumping = false;
+
+    locate();
+    updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
+}
+
 void LatticesProcessor::locate()
 {
     positionXY.first = fromXYParam(xParam->get());
     positionXY.second = fromXYParam(yParam->get());
+    for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+    {
+        positionExtra[a] = fromXYParam(axisParams[a]->get());
+    }
 
     if (mode == Syntonic)
     {
@@ -753,33 +1114,28 @@ void LatticesProcessor::locate()
             int nn = originalRefNote;
             double nf = 1.0;
 
-            int absx = std::abs(positionXY.first);
-            double mul = positionXY.first < 0 ? 1 / 1.5 : 1.5; // fifth down : fifth up
-            int add = positionXY.first < 0 ? -7 : 7;
-            for (int i = 0; i < absx; ++i)
+            // One lookup per axis however far out we are, see walk_t
+            auto walk = [&](const lattices::scaledata::walk_t &w, int p)
             {
-                nn += add;
-                nf *= mul;
-            }
-
-            int absy = std::abs(positionXY.second);
-            mul = positionXY.second < 0 ? 1 / 1.25 : 1.25; // third down : third up
-            add = positionXY.second < 0 ? -4 : 4;
-            for (int i = 0; i < absy; ++i)
+                int q = (p >= 0) ? p / scaleSize : (p - scaleSize + 1) / scaleSize;
+                int r = p - q * scaleSize;
+                nn += w.degrees[r];
+                nf *= w.ratios[r];
+                if (q != 0)
+                    nf *= std::pow(w.comma, q);
+            };
+
+            walk(latticeLayout.walks[0], positionXY.first);
+            walk(latticeLayout.walks[1], positionXY.second);
+            for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
             {
-                nn += add;
-                nf *= mul;
+                walk(latticeLayout.walks[2 + a], positionExtra[a]);
             }
 
-            while (nn < 0)
-            {
-                nn += 12;
-                nf *= 2.0;
-            }
-            while (nn >= 12)
+            while (nn >= scaleSize)
             {
-                nn -= 12;
-                nf *= 0.5;
+                nn -= scaleSize;
+                nf /= latticeLayout.periodRatio;
             }
 
             currentRefNote = nn;
@@ -793,39 +1149,46 @@ void LatticesProcessor::locate()
 
 void LatticesProcessor::updateTuning()
 {
-    changed = true;
+    changes.publish(lattices::ChangeBus::Tuning);
+
+    auto periodPowers = latticeLayout.periodPowers.data() + lattices::scaledata::periodReach;
 
     if (mode == Syntonic)
     {
-        int refMidiNote = originalRefNote + 60;
-        for (int note = 0; note < 128; ++note)
+        double syntonicRatios[12]{};
+        for (int d = 0; d < 12; ++d)
         {
-            double octaveShift = std::pow(2, std::floor(((double)note - refMidiNote) / 12.0));
-
-            int degree = (note - refMidiNote) % 12;
-            if (degree < 0)
-            {
-                degree += 12;
-            }
-
-            freqs[note] = originalRefFreq * syntonicGroup.getTuning(degree) * octaveShift;
+            syntonicRatios[d] = syntonicGroup.getTuning(d);
         }
+
+        fillFrequencies<12>(originalRefNote + 60, originalRefFreq, syntonicRatios, periodPowers);
     }
     else
     {
         int refMidiNote = currentRefNote + 60;
-        for (int note = 0; note < 128; ++note)
-        {
-            double octaveShift = std::pow(2, std::floor(((double)note - refMidiNote) / 12.0));
+        double refFreq = originalRefFreq * ratioToOriginal;
+        auto ratios = currentVisitors->CT.data();
 
-            int degree = (note - refMidiNote) % 12;
-            if (degree < 0)
-            {
-                degree += 12;
-            }
-
-            freqs[note] =
-                originalRefFreq * ratioToOriginal * currentVisitors->CT[degree] * octaveShift;
+        switch (scaleSize)
+        {
+        case 7:
+            fillFrequencies<7>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
+        case 13:
+            fillFrequencies<13>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
+        case 19:
+            fillFrequencies<19>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
+        case 22:
+            fillFrequencies<22>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
+        case 31:
+            fillFrequencies<31>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
+        default:
+            fillFrequencies<12>(refMidiNote, refFreq, ratios, periodPowers);
+            break;
         }
     }
 
@@ -836,6 +1199,23 @@ void LatticesProcessor::updateTuning()
     updateHostDisplay(juce::AudioProcessor::ChangeDetails().withNonParameterStateChanged(true));
 }
 
+// Specialised per scale size, so the common 12 note case divides by a constant.
+// periodPowers points at period^0 in the layout's table, which reaches every
+// period the keyboard can.
+template <int N>
+void LatticesProcessor::fillFrequencies(int refMidiNote, double refFreq,
+                                        const double *degreeRatios, const double *periodPowers)
+{
+    for (int note = 0; note < 128; ++note)
+    {
+        int steps = note - refMidiNote;
+        int period = (steps >= 0) ? steps / N : (steps - N + 1) / N;
+        int degree = steps - period * N;
+
+        freqs[note] = refFreq * degreeRatios[degree] * periodPowers[period];
+    }
+}
+
 //==============================================================================
 // This creates new instances of the plugin.
 juce::AudioProcessor *JUCE_CALLTYPE createPluginFilter() { return new LatticesProcessor(); }
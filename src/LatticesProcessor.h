@@ -17,6 +17,7 @@
 #include <string>
 #include <mutex>
 
+#include "ChangeBus.h"
 #include "JIMath.h"
 #include "ScaleData.h"
 
@@ -56,11 +57,17 @@ class LatticesProcessor : public juce::AudioProcessor,
     void timerCallback(int timerID) override;
 
     void modeSwitch(int m);
-    void updateMIDICC(int hCC);
+    // these two refuse a CC that would share a number with the other's, see ccsOverlap()
+    bool updateMIDICC(int hCC);
+    bool updateAxisCC(int aCC);
     void updateMIDIChannel(int C);
     void updateFreq(double f);
     double updateRoot(int r);
     void updateDistance(int dist);
+    void updateLowPower(bool on);
+    void updateScaleSize(int n);
+    void updateGenerators(uint64_t hN, uint64_t hD, uint64_t dN, uint64_t dD);
+    void updatePeriod(uint64_t pN, uint64_t pD);
     bool newVisitorGroup();
     void resetVisitorGroup();
     void deleteVisitorGroup(int idx);
@@ -75,6 +82,10 @@ class LatticesProcessor : public juce::AudioProcessor,
 
     void parameterValueChanged(int parameterIndex, float newValue) override;
     void shift(int dir);
+    void jumpTo(int x, int y); // takes the root to that cell
+
+    // what the editor subscribes to, instead of checking up on us
+    lattices::ChangeBus changes;
 
     bool registeredMTS{false};
     bool MTSreInit{false};
@@ -86,10 +97,11 @@ class LatticesProcessor : public juce::AudioProcessor,
         Syntonic,
     };
     std::atomic<Mode> mode = Duodene;
-    std::atomic<bool> changed{false};
     std::atomic<int> numClients{0};
 
     int homeCC = 14;
+    // four CCs from here step up/down along the 7 and then the 11 axis
+    int axisCC = 102;
     int listenOnChannel = 1;
 
     // key, frequency and name of the origin note
@@ -102,28 +114,45 @@ class LatticesProcessor : public juce::AudioProcessor,
     double ratioToOriginal{1.0};
 
     std::pair<int, int> positionXY{0, 0};
-    // coordinates of current scale
-    std::pair<int, int> coOrds[12]{};
+    // steps taken along the 7 and 11 axes
+    std::array<int, lattices::scaledata::numExtraAxes> positionExtra{};
+    // coordinates of current scale, as seen on the 3-5 plane
+    std::pair<int, int> coOrds[lattices::scaledata::maxDegrees]{};
+    // the higher axes of that plane, packed as in coordN_t::extra
+    uint64_t activePlane{0};
+    // and which degree is where, looked up by full coordinate
+    lattices::scaledata::active_cells_t activeCells;
+
+    // number of degrees per octave, one of lattices::scaledata::scaleSizes
+    int scaleSize{12};
+    // the ratios one step east and one step north, the period, and what they lay
+    // out for the scale size. The visitor groups all point at this layout.
+    JIMath jim;
+    lattices::scaledata::layout_t latticeLayout{lattices::scaledata::getLayout(12)};
+    // the commas visitors can be, ours and then the user's, see loadCommaRegistry()
+    lattices::scaledata::comma_registry_t commaRegistry{lattices::scaledata::builtInCommas};
 
     std::vector<lattices::scaledata::ScaleData> visitorGroups;
     lattices::scaledata::ScaleData *currentVisitors;
-    uint8_t numVisitorGroups{0};
+    int numVisitorGroups{0};
+    static constexpr int maxVisitorGroups{1024}; // all the visitors parameter can pick
     bool stopVisitorChanges{false};
-    uint8_t priorSelectedGroup{0};
+    int priorSelectedGroup{0};
     bool onOriginReturn{false};
+    bool jumping{false}; // jumpTo() moves both axes, then locates once
 
     lattices::scaledata::SyntonicData syntonicGroup;
 
-    bool loadedState{false};
-
     uint16_t maxDistance{24};
 
+    // draw the lattices flat, without blurred shadows or easing, for slower machines
+    bool lowPower{false};
+
   private:
     // fallbacks for the origin
     static constexpr int defaultRefNote{0};
     static constexpr double defaultRefFreq{261.6255653005986};
     std::pair<uint8_t, int> defaultOriginNoteName = {1, 0};
-    const JIMath jim;
 
     enum Direction
     {
@@ -131,42 +160,69 @@ class LatticesProcessor : public juce::AudioProcessor,
         West,
         East,
         North,
-        South
+        South,
+        Up7,
+        Down7,
+        Up11,
+        Down11
     };
 
     void returnToOrigin();
+    void rebuildLayout();
+    void relayout();
+    void loadCommaRegistry();
 
     void respondToMidi(const juce::MidiMessage &m);
+    // home and the four directions from homeCC, then one per visitor group for as
+    // long as there are CC numbers left before the axis CCs or the end, past that
+    // they can't be sent
+    int numHomeCCs() const
+    {
+        int room = (axisCC > homeCC) ? axisCC - homeCC : 128 - homeCC;
+        return juce::jmin(5 + numVisitorGroups - 1, room);
+    }
+    static constexpr int numAxisCCs{2 * lattices::scaledata::numExtraAxes};
+    // whether home and its four directions would share a number with the axis CCs
+    static bool ccsOverlap(int home, int axis)
+    {
+        return home < axis + numAxisCCs && axis < home + 5;
+    }
     std::vector<bool> hold = {false, false, false, false, false};
     std::vector<bool> wait = {false, false, false, false, false};
+    std::vector<bool> axisHold = {false, false, false, false};
+    std::vector<bool> axisWait = {false, false, false, false};
 
     std::mutex visLock;
 
     void locate();
     void updateTuning();
+    template <int N>
+    void fillFrequencies(int refMidiNote, double refFreq, const double *degreeRatios,
+                         const double *periodPowers);
 
     double freqs[128]{};
 
     juce::AudioParameterFloat *xParam;
     juce::AudioParameterFloat *yParam;
-    juce::AudioParameterFloat *vParam;
+    juce::AudioParameterInt *vParam;
     juce::AudioParameterFloat *fParam;
+    juce::AudioParameterFloat *axisParams[lattices::scaledata::numExtraAxes]{};
 
     // define these here lest the lambda functions
     // below throw an annoying "not defined" warning
 
+    // The visitors parameter counts groups over a range that never changes, so
+    // automation keeps picking the same group however many come and go.
+    // Past the last group there's nobody.
     double toVisitorParam(int input) const
     {
-        if (visitorGroups.size() <= 1)
-            return 0.0;
-        return static_cast<double>(input) / (visitorGroups.size() - 1);
+        return static_cast<double>(juce::jlimit(0, maxVisitorGroups - 1, input)) /
+               (maxVisitorGroups - 1);
     }
 
-    inline int fromVisitorParam(float input) const
+    inline int fromVisitorParam(int input) const
     {
-        if (visitorGroups.size() <= 1)
-            return 0;
-        return static_cast<int>(std::round(input * (visitorGroups.size() - 1)));
+        return (input >= 0 && input < static_cast<int>(visitorGroups.size())) ? input : 0;
     }
 
     inline double toXYParam(int input, bool v = false) const
@@ -230,6 +286,17 @@ class LatticesProcessor : public juce::AudioProcessor,
         return dir;
     }
 
+    juce::String toStringAxis(float value, int axis)
+    {
+        int v = fromXYParam(value);
+
+        if (v == 0)
+            return "Home";
+
+        auto p = std::to_string(lattices::scaledata::extraAxes[axis].num);
+        return p + "-Limit " + ((v > 0) ? "+" : "-") + std::to_string(std::abs(v));
+    }
+
     std::string whereAreWe(float VX, float VY)
     {
         auto tmpX = toStringX(VX).toStdString();
@@ -238,6 +305,16 @@ class LatticesProcessor : public juce::AudioProcessor,
         auto tmpY = toStringY(VY).toStdString();
         auto NS = (tmpY != "Home") ? tmpY : "";
 
+        for (int a = 0; a < lattices::scaledata::numExtraAxes; ++a)
+        {
+            auto tmpA = toStringAxis(axisParams[a]->get(), a).toStdString();
+            if (tmpA != "Home")
+            {
+                NS += (NS.empty()) ? "" : ", ";
+                NS += tmpA;
+            }
+        }
+
         if (EW.empty() && NS.empty())
         {
             return "Home";
@@ -345,13 +422,29 @@ class LatticesProcessor : public juce::AudioProcessor,
                     return res;
                 });
 
-    const juce::AudioParameterFloatAttributes visitorsReadout =
-        juce::AudioParameterFloatAttributes{}
+    juce::AudioParameterFloatAttributes axisReadout(int axis)
+    {
+        return juce::AudioParameterFloatAttributes{}
             .withStringFromValueFunction(
-                [this](float value, int maximumStringLength) -> juce::String
+                [this, axis](float value, int maximumStringLength) -> juce::String
+                { return toStringAxis(value, axis); })
+            .withValueFromStringFunction(
+                [this](juce::String str)
+                {
+                    if (str == "Home")
+                        return 0.5;
+
+                    auto v = str.fromLastOccurrenceOf(" ", false, false).removeCharacters("+");
+                    return toXYParam(v.getIntValue());
+                });
+    }
+
+    const juce::AudioParameterIntAttributes visitorsReadout =
+        juce::AudioParameterIntAttributes{}
+            .withStringFromValueFunction(
+                [this](int value, int maximumStringLength) -> juce::String
                 { return std::to_string(fromVisitorParam(value)); })
-            .withValueFromStringFunction([this](juce::String str)
-                                         { return toVisitorParam(str.getIntValue()); });
+            .withValueFromStringFunction([](juce::String str) { return str.getIntValue(); });
 
     const juce::AudioParameterFloatAttributes frequencyReadout =
         juce::AudioParameterFloatAttributes{}
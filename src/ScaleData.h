@@ -13,6 +13,12 @@
 
 #pragma once
 
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <string>
 #include <utility>
 //==============================================================================
 namespace lattices::scaledata
@@ -63,8 +69,8 @@ enum CommaNames
 // The root note could be either, so eventually I'll make a
 // feature that lets the user flip the first of these. kk
 // todo: make the feature that lets you choose which it is.
-static bool isDegreeMajor[12] = {false, false, true,  false, true,  false,
-                                 true,  true,  false, true,  false, true};
+static constexpr bool isDegreeMajor[12] = {false, false, true,  false, true,  false,
+                                           true,  true,  false, true,  false, true};
 
 // A comma defined by its name, its ratio as a fraction,
 // that fraction and its reciprocal expressed as doubles
@@ -87,22 +93,18 @@ struct comma_t
         minorRatio = 1.0 / majorRatio;
         nameIndex = static_cast<int>(n);
     }
+    // commas from the user's file have no name in the enum, only their registry index
+    constexpr comma_t(int index, frac_t f, coord_t c) : comma_t(none, f, c) { nameIndex = index; }
     comma_t(const comma_t &) = default;
     comma_t(comma_t &&) noexcept = default;
     comma_t &operator=(const comma_t &) = default;
     comma_t &operator=(comma_t &&) noexcept = default;
     ~comma_t() noexcept = default;
 
-    double getRatio(int degree) const { return isDegreeMajor[degree] ? majorRatio : minorRatio; }
-    frac_t getFraction(int degree) const
-    {
-        if (isDegreeMajor[degree])
-            return fraction;
-
-        auto res = std::make_pair(fraction.second, fraction.first);
-        return res;
-    }
-    frac_t getFraction(bool major) const
+    // Whether a degree is major depends on the scale size,
+    // so ask the scale's layout_t (below) rather than guessing.
+    constexpr double getRatio(bool major) const { return major ? majorRatio : minorRatio; }
+    constexpr frac_t getFraction(bool major) const
     {
         if (major)
             return fraction;
@@ -110,9 +112,9 @@ struct comma_t
         auto res = std::make_pair(fraction.second, fraction.first);
         return res;
     }
-    coord_t getCoord(int degree) const
+    constexpr coord_t getCoord(bool major) const
     {
-        if (isDegreeMajor[degree])
+        if (major)
             return coord;
 
         coord_t res = {coord.first * -1, coord.second * -1};
@@ -129,12 +131,13 @@ struct comma_t
 };
 // Here's the commas I've included so far (though we are not yet using them all).
 // Any questions about these choices, feel free to open a Github issue.
-// To add a comma, add a name at the end of the enum, add an initializer with a
+// To add a comma here, add a name at the end of the enum, add an initializer with a
 // name and ratio at the end of this array, add a pair of colors in LatticeColours.h,
-// and add a control in VisitorsComponent.h
+// and a label and accidentals in makeBuiltInRegistry() below.
+// Users can add their own without any of that, see comma_registry_t.
 // Do not change the order after 1.0
-// TODO: write a test that checks this against the enum
-static constexpr comma_t commas[17] = {
+static constexpr int numBuiltInCommas{16};
+static constexpr comma_t commas[numBuiltInCommas] = {
     comma_t(),
     comma_t(syntonic, {80, 81}),
     comma_t(septimal, {64, 63}),
@@ -152,6 +155,110 @@ static constexpr comma_t commas[17] = {
     comma_t(fourteenovereleven, {896, 891}),
     comma_t(fourteenoverthirteen, {1701, 1664}),
 };
+static_assert(fourteenoverthirteen + 1 == numBuiltInCommas, "commas[] and CommaNames disagree");
+
+// Every comma a visitor can be, the built in ones first and then any from the
+// user's file, flattened into tables by index so that tuning, placing and
+// naming a user comma is the same lookup as for a built in one.
+// The index is what gets saved, so user commas should only ever be appended.
+static constexpr int maxUserCommas{9}; // what fits next to ours in the visitors menu
+static constexpr int maxCommas{numBuiltInCommas + maxUserCommas};
+
+typedef std::array<char, 32> glyph_t; // UTF-8, null terminated
+
+// whether s fits in a glyph as it is, check before making one of anything from outside
+constexpr bool glyphFits(const char *s)
+{
+    size_t n{0};
+    while (s[n] != 0)
+        ++n;
+    return n < glyph_t{}.size();
+}
+
+// Anything that doesn't fit is cut at the last whole character, never inside one
+constexpr glyph_t makeGlyph(const char *s)
+{
+    glyph_t g{};
+    size_t n{0};
+    while (n + 1 < g.size() && s[n] != 0)
+        ++n;
+    if (s[n] != 0)
+    {
+        while (n > 0 && (static_cast<unsigned char>(s[n]) & 0xC0) == 0x80)
+            --n; // s[n] continues a character, so that whole character goes
+    }
+    for (size_t i = 0; i < n; ++i)
+        g[i] = s[i];
+    return g;
+}
+
+struct comma_registry_t
+{
+    int size{0};
+    std::array<comma_t, maxCommas> commas{};  // ratio and lattice offset
+    std::array<glyph_t, maxCommas> labels{};  // what its visitors menu button says
+    std::array<glyph_t, maxCommas> majorAccidentals{}, minorAccidentals{};
+    std::array<uint32_t, maxCommas> colourFrom{}, colourTo{}; // ARGB, 0 for our palette
+
+    // the visitors menu, in button order, and which button each comma has (or -1)
+    int numOffered{0};
+    std::array<int, maxCommas> offered{};
+    std::array<int, maxCommas> buttonOf{};
+
+    // false once full
+    constexpr bool add(const comma_t &c, const char *label, const char *majorAcc,
+                       const char *minorAcc, bool offer = true, uint32_t from = 0, uint32_t to = 0)
+    {
+        if (size >= maxCommas)
+            return false;
+
+        commas[size] = c;
+        commas[size].nameIndex = size;
+        labels[size] = makeGlyph(label);
+        majorAccidentals[size] = makeGlyph(majorAcc);
+        minorAccidentals[size] = makeGlyph(minorAcc);
+        colourFrom[size] = from;
+        colourTo[size] = to;
+        buttonOf[size] = -1;
+        if (offer)
+        {
+            buttonOf[size] = numOffered;
+            offered[numOffered++] = size;
+        }
+        ++size;
+        return true;
+    }
+
+    // unknown indices (say a state saved with a comma file we no longer have) are no comma
+    constexpr int valid(int c) const { return (c >= 0 && c < size) ? c : none; }
+
+    constexpr const char *accidental(int c, bool major) const
+    {
+        return major ? majorAccidentals[c].data() : minorAccidentals[c].data();
+    }
+};
+
+// The syntonic comma carries no accidental, since the lattice rows mark it already
+constexpr comma_registry_t makeBuiltInRegistry()
+{
+    constexpr const char *labels[numBuiltInCommas] = {
+        "3",  "5",  "7",  "11",  "13",    "17",    "19",    "23",
+        "29", "31", "7/5", "11/10", "13/10", "13/11", "14/11", "14/13"};
+    constexpr const char *accidentals[numBuiltInCommas][2] = {
+        {"", ""},   {"", ""},   {")", "("}, {">", "<"}, {"{", "}"}, {":", ";"},
+        {",", "."}, {"", ""},   {"", ""},   {"", ""},   {"", ""},   {"", ""},
+        {"", ""},   {"", ""},   {"", ""},   {"", ""}};
+
+    comma_registry_t r{};
+    for (int i = 0; i < numBuiltInCommas; ++i)
+    {
+        // the menu has only ever offered up to the 19-limit
+        r.add(commas[i], labels[i], accidentals[i][0], accidentals[i][1], i <= novemdecimal);
+    }
+    return r;
+}
+
+static constexpr comma_registry_t builtInCommas = makeBuiltInRegistry();
 
 static constexpr comma_t defaultCommas[12] = {
     comma_t(),
@@ -168,17 +275,448 @@ static constexpr comma_t defaultCommas[12] = {
     comma_t(syntonic, {80, 81}),
 };
 
+// =================================================================================================
+// Scales of other sizes than 12, and lattices of other generators.
+//
+// A scale of size N sits on the lattice through the number of degrees that one
+// step east (3/2 by default) and one step north (5/4) moves us, which is to say
+// the patent val of N-EDO. The degree of any cell is (fifthSteps * x + thirdSteps * y)
+// mod N, just like it is (7x + 4y) mod 12 on a regular keyboard.
+//
+// Each degree starts out as the member of a chain of N horizontal steps
+// (from chainStart and up) that lands on it, and it is major if that member sits
+// east of the root. One row up the lattice is a chain member times a small comma,
+// the row comma, and the default scale takes it on every degree where that gives
+// a simpler ratio. For 3/2 and 5/4 that comma is the syntonic, and 12 notes gets
+// us the Duodene.
+//
+// All of which is reduced by the period, an octave by default. With a tritave and
+// 13 notes the same machinery lays out a Bohlen-Pierce scale.
+
+// The largest scale we lay out. Per-degree storage is sized to fit it
+// so that changing sizes never needs to allocate anything.
+static constexpr int maxDegrees{31};
+
+// The sizes we know about, in the order the settings menu lists them
+static constexpr int numScaleSizes{6};
+static constexpr int scaleSizes[numScaleSizes] = {7, 12, 13, 19, 22, 31};
+
+// How many periods up or down the 128 MIDI notes can reach at the smallest size
+static constexpr int periodReach{128 / scaleSizes[0] + 1};
+
+// The generator pairs the settings offer, east first and then north
+struct generators_t
+{
+    frac_t horizontal, diagonal;
+    const char *name;
+};
+
+static constexpr int numGeneratorPresets{4};
+static constexpr generators_t generatorPresets[numGeneratorPresets] = {
+    {{3, 2}, {5, 4}, "3/2 5/4"},
+    {{3, 2}, {7, 4}, "3/2 7/4"},
+    {{4, 3}, {6, 5}, "4/3 6/5"},
+    {{5, 3}, {7, 5}, "5/3 7/5"}}; // Bohlen-Pierce, with a tritave
+
+// ...and the periods
+struct period_t
+{
+    frac_t ratio;
+    const char *name;
+};
+
+static constexpr int numPeriodPresets{3};
+static constexpr period_t periodPresets[numPeriodPresets] = {
+    {{2, 1}, "2/1"}, {{3, 1}, "3/1"}, {{3, 2}, "3/2"}};
+
+// Past the 5-limit plane the lattice goes on along one axis per higher prime.
+// Stepping along one of them moves the whole scale by that prime's ratio, which
+// spells as a pythagorean note (fifths away from the root) plus an accidental.
+static constexpr int numExtraAxes{2};
+
+struct axis_t
+{
+    uint64_t num, den;
+    double ratio;
+    int fifths;
+    const char *upAccidental, *downAccidental;
+};
+
+static constexpr axis_t extraAxes[numExtraAxes] = {
+    {7, 4, 7.0 / 4.0, -2, "(", ")"},  // 7/4 is Bb, 63/64 flat
+    {11, 8, 11.0 / 8.0, -1, "<", ">"} // 11/8 is F, 33/32 sharp
+};
+
+// A point on the lattice. x and y are the 3 and 5 axes we draw, and the higher
+// axes are kept sparsely, packed 16 signed bits each into one word. That word
+// is zero anywhere on the plane, so 2D coordinates cost nothing extra.
+struct coordN_t
+{
+    int x{0}, y{0};
+    uint64_t extra{0};
+
+    constexpr int axis(int a) const
+    {
+        return static_cast<int16_t>((extra >> (16 * a)) & 0xFFFF);
+    }
+    constexpr void setAxis(int a, int v)
+    {
+        extra &= ~(uint64_t{0xFFFF} << (16 * a));
+        extra |= (static_cast<uint64_t>(static_cast<uint16_t>(v)) << (16 * a));
+    }
+    constexpr bool onPlane() const { return extra == 0; }
+    constexpr bool operator==(const coordN_t &) const = default;
+};
+
+// Which degree sits at each of the lit cells. A small open addressing table
+// keyed on the full coordinate, so finding a cell is O(1) however many axes
+// are in play, and rebuilding it never allocates.
+struct active_cells_t
+{
+    void clear() { degrees.fill(-1); }
+
+    // a later degree on the same cell wins, same as scanning them in order did
+    void insert(const coordN_t &c, int degree)
+    {
+        auto i = slot(c);
+        while (degrees[i] >= 0 && !(cells[i] == c))
+            i = (i + 1) & (capacity - 1);
+
+        cells[i] = c;
+        degrees[i] = static_cast<int8_t>(degree);
+    }
+
+    // -1 if nothing is lit there
+    int find(const coordN_t &c) const
+    {
+        auto i = slot(c);
+        while (degrees[i] >= 0)
+        {
+            if (cells[i] == c)
+                return degrees[i];
+            i = (i + 1) & (capacity - 1);
+        }
+        return -1;
+    }
+
+  private:
+    static constexpr int capacity{64}; // a power of two, with plenty of room to spare
+    std::array<coordN_t, capacity> cells{};
+    std::array<int8_t, capacity> degrees = [] {
+        std::array<int8_t, capacity> r{};
+        r.fill(-1);
+        return r;
+    }();
+
+    static int slot(const coordN_t &c)
+    {
+        auto h = static_cast<uint64_t>(c.x) * 0x9E3779B97F4A7C15ULL;
+        h ^= static_cast<uint64_t>(c.y) * 0xC2B2AE3D27D4EB4FULL;
+        h ^= c.extra * 0x165667B19E3779F9ULL;
+        return static_cast<int>((h >> 32) & (capacity - 1));
+    }
+};
+
+// Walking p = q * N + r steps along one axis moves us degrees[r] degrees, and
+// once that is folded back into the octave the ratio we moved by is
+// ratios[r] * comma^q. The comma being N steps of the axis less its octaves.
+struct walk_t
+{
+    std::array<int, maxDegrees> degrees{};
+    std::array<double, maxDegrees> ratios{};
+    double comma{1.0};
+};
+
+struct layout_t
+{
+    int size{12}, fifthSteps{7}, thirdSteps{4}, chainStart{-5};
+    std::array<int, numExtraAxes> extraSteps{10, 6}; // patent val for 7/4 and 11/8
+    frac_t horizontal{3, 2}, diagonal{5, 4}, period{2, 1};
+    comma_t rowComma{syntonic, {80, 81}}; // stored as taken by a major degree
+    int rowPrime{5};                      // the prime it brings in, which names its button
+
+    // Our other commas all sit a syntonic comma's place away, {-4, 1}, so they only
+    // land in the right cell on layouts where that's where the row comma is.
+    bool builtInVisitors{true};
+
+    // the period as a double, and raised to every power the keyboard reaches,
+    // indexed from -periodReach
+    double periodRatio{2.0};
+    std::array<double, 2 * periodReach + 1> periodPowers{};
+
+    std::array<frac_t, maxDegrees> fractions{}; // chain fraction of each degree
+    std::array<double, maxDegrees> ratios{};    // and the same as a double
+    std::array<coord_t, maxDegrees> coords{};   // its place on the chain
+    std::array<bool, maxDegrees> major{};       // east or west of the root
+    std::array<CommaNames, maxDegrees> defaults{};
+
+    // horizontal, diagonal, then the extra axes in order
+    std::array<walk_t, 2 + numExtraAxes> walks{};
+
+    constexpr int degreeAt(int x, int y) const
+    {
+        return ((fifthSteps * x + thirdSteps * y) % size + size) % size;
+    }
+
+    // whether a degree can take comma c (a registry index) on this layout
+    constexpr bool takes(int c) const
+    {
+        return builtInVisitors || c <= syntonic || c >= numBuiltInCommas;
+    }
+};
+
+constexpr int largestPrime(uint64_t n)
+{
+    uint64_t p{1};
+    for (uint64_t f = 2; f * f <= n; ++f)
+    {
+        while (n % f == 0)
+        {
+            p = f;
+            n /= f;
+        }
+    }
+    return static_cast<int>(n > 1 ? n : p);
+}
+
+constexpr walk_t makeWalk(int size, int steps, double ratio, double periodRatio)
+{
+    walk_t w{};
+    double r{1.0};
+    int acc{0};
+    for (int i = 0; i < size; ++i)
+    {
+        w.degrees[i] = acc;
+        w.ratios[i] = r;
+        r *= ratio;
+        acc += steps;
+        while (acc >= size)
+        {
+            acc -= size;
+            r /= periodRatio;
+        }
+    }
+    w.comma = r;
+    return w;
+}
+
+constexpr layout_t makeLayout(int size, int fifthSteps, int thirdSteps, int chainStart,
+                              std::array<int, numExtraAxes> extraSteps,
+                              frac_t horizontal = {3, 2}, frac_t diagonal = {5, 4},
+                              frac_t period = {2, 1})
+{
+    layout_t l{};
+    l.size = size;
+    l.fifthSteps = fifthSteps;
+    l.thirdSteps = thirdSteps;
+    l.chainStart = chainStart;
+    l.extraSteps = extraSteps;
+    l.horizontal = horizontal;
+    l.diagonal = diagonal;
+    l.period = period;
+
+    auto [pn, pd] = period;
+    l.periodRatio = static_cast<double>(pn) / static_cast<double>(pd);
+    l.periodPowers[periodReach] = 1.0;
+    for (int i = 1; i <= periodReach; ++i)
+    {
+        l.periodPowers[periodReach + i] = l.periodPowers[periodReach + i - 1] * l.periodRatio;
+        l.periodPowers[periodReach - i] = l.periodPowers[periodReach - i + 1] / l.periodRatio;
+    }
+
+    auto [hn, hd] = horizontal;
+    int rowStart{0};
+    for (int k = chainStart; k < chainStart + size; ++k)
+    {
+        uint64_t n{1}, d{1};
+        for (int i = 0; i < std::abs(k); ++i)
+        {
+            n *= (k < 0) ? hd : hn;
+            d *= (k < 0) ? hn : hd;
+            auto g = std::gcd(n, d);
+            n /= g;
+            d /= g;
+        }
+        while (n < d)
+        {
+            n *= pn;
+            d *= pd;
+        }
+        while (n * pd >= d * pn)
+        {
+            n *= pd;
+            d *= pn;
+        }
+        auto g = std::gcd(n, d);
+        n /= g;
+        d /= g;
+
+        int degree = ((k * fifthSteps) % size + size) % size;
+        l.fractions[degree] = {n, d};
+        l.ratios[degree] = static_cast<double>(n) / static_cast<double>(d);
+        l.coords[degree] = {k, 0};
+        l.major[degree] = k > 0;
+
+        if (degree == ((thirdSteps % size) + size) % size)
+            rowStart = k;
+    }
+
+    // The row comma takes the chain member under the diagonal up to it
+    auto [cn, cd] = l.fractions[l.degreeAt(0, 1)];
+    auto rn = diagonal.first * cd;
+    auto rd = diagonal.second * cn;
+    auto g = std::gcd(rn, rd);
+    rn /= g;
+    rd /= g;
+    if (rowStart >= 0)
+        l.rowComma = comma_t(syntonic, {rn, rd}, {-rowStart, 1});
+    else
+        l.rowComma = comma_t(syntonic, {rd, rn}, {rowStart, -1});
+    l.rowPrime = largestPrime(diagonal.first * diagonal.second);
+    l.builtInVisitors = l.rowComma.getFraction(true) == frac_t{80, 81} &&
+                        l.rowComma.getCoord(true) == coord_t{-4, 1};
+
+    // Would a degree be simpler a row comma away?
+    for (int d = 0; d < size; ++d)
+    {
+        auto [n, dn] = l.fractions[d];
+        auto [fn, fd] = l.rowComma.getFraction(l.major[d]);
+        auto sn = n * fn;
+        auto sd = dn * fd;
+        auto sg = std::gcd(sn, sd);
+        sn /= sg;
+        sd /= sg;
+        l.defaults[d] = (static_cast<double>(sn) * static_cast<double>(sd) <
+                         static_cast<double>(n) * static_cast<double>(dn))
+                            ? syntonic
+                            : none;
+    }
+
+    l.walks[0] = makeWalk(size, fifthSteps, static_cast<double>(hn) / static_cast<double>(hd),
+                          l.periodRatio);
+    auto [dn, dd] = diagonal;
+    l.walks[1] = makeWalk(size, thirdSteps, static_cast<double>(dn) / static_cast<double>(dd),
+                          l.periodRatio);
+    for (int a = 0; a < numExtraAxes; ++a)
+        l.walks[2 + a] = makeWalk(size, extraSteps[a], extraAxes[a].ratio, l.periodRatio);
+
+    return l;
+}
+
+static constexpr layout_t layouts[numScaleSizes] = {
+    makeLayout(7, 4, 2, -1, {6, 3}),       makeLayout(12, 7, 4, -5, {10, 6}),
+    makeLayout(13, 8, 4, -6, {10, 6}),     makeLayout(19, 11, 6, -9, {15, 9}),
+    makeLayout(22, 13, 7, -10, {18, 10}),  makeLayout(31, 18, 10, -15, {25, 14})};
+
+constexpr bool isSupportedSize(int size)
+{
+    for (int i = 0; i < numScaleSizes; ++i)
+    {
+        if (scaleSizes[i] == size)
+            return true;
+    }
+    return false;
+}
+
+// Unknown sizes fall back to 12
+constexpr const layout_t &getLayout(int size)
+{
+    for (int i = 0; i < numScaleSizes; ++i)
+    {
+        if (scaleSizes[i] == size)
+            return layouts[i];
+    }
+    return layouts[1];
+}
+
+template <int N> constexpr const layout_t &layoutFor()
+{
+    static_assert(isSupportedSize(N), "No lattice layout for this scale size");
+    return getLayout(N);
+}
+
+// The fifth has to reach every degree, or some would be left without a place
+constexpr bool layoutsAreComplete()
+{
+    for (const auto &l : layouts)
+    {
+        if (std::gcd(l.fifthSteps, l.size) != 1 || l.size > maxDegrees)
+            return false;
+    }
+    return true;
+}
+static_assert(layoutsAreComplete(), "A scale layout leaves degrees unreachable");
+
+// ...and the generic layout better still give us the scale we started with
+constexpr bool layoutMatchesDuodene()
+{
+    auto &l = getLayout(12);
+    if (l.rowComma.getFraction(true) != frac_t{80, 81} ||
+        l.rowComma.getCoord(true) != coord_t{-4, 1})
+        return false;
+    for (int d = 0; d < 12; ++d)
+    {
+        if (l.fractions[d] != pyth12fractions[d] || l.coords[d] != pyth12coords[d] ||
+            l.major[d] != isDegreeMajor[d] || l.defaults[d] != defaultCommas[d].nameIndex)
+            return false;
+    }
+    return true;
+}
+static_assert(layoutMatchesDuodene(), "The 12 note layout no longer matches the Duodene");
+
+// Patent val: how many degrees of N equal divisions of the period land nearest to a ratio
+inline int patentVal(int size, uint64_t num, uint64_t den, frac_t period = {2, 1})
+{
+    auto r = static_cast<double>(num) / static_cast<double>(den);
+    auto p = static_cast<double>(period.first) / static_cast<double>(period.second);
+    return static_cast<int>(std::lround(size * std::log(r) / std::log(p)));
+}
+
+// The horizontal step has to reach every degree, and everything has to go up.
+// Both steps have to stay inside the period too, or the chain would fold them
+// back into some other interval than the one the axis is named for.
+inline bool generatorsFit(int size, frac_t horizontal, frac_t diagonal, frac_t period = {2, 1})
+{
+    if (horizontal.first <= horizontal.second || diagonal.first <= diagonal.second ||
+        period.first <= period.second)
+        return false;
+    auto within = [period](frac_t f) { return f.first * period.second < f.second * period.first; };
+    if (!within(horizontal) || !within(diagonal))
+        return false;
+    auto h = patentVal(size, horizontal.first, horizontal.second, period);
+    return h > 0 && std::gcd(h, size) == 1;
+}
+
+// The layouts for other generators and periods are built when they're chosen.
+// The defaults come straight out of the table above.
+inline layout_t buildLayout(int size, frac_t horizontal, frac_t diagonal, frac_t period = {2, 1})
+{
+    auto &base = getLayout(size);
+    if ((horizontal == frac_t{3, 2} && diagonal == frac_t{5, 4} && period == frac_t{2, 1}) ||
+        !generatorsFit(base.size, horizontal, diagonal, period))
+        return base;
+
+    std::array<int, numExtraAxes> extraSteps{};
+    for (int a = 0; a < numExtraAxes; ++a)
+        extraSteps[a] = patentVal(base.size, extraAxes[a].num, extraAxes[a].den, period);
+
+    return makeLayout(base.size, patentVal(base.size, horizontal.first, horizontal.second, period),
+                      patentVal(base.size, diagonal.first, diagonal.second, period),
+                      base.chainStart, extraSteps, horizontal, diagonal, period);
+}
+
 struct ScaleData
 {
-    ScaleData(const std::string n, const int *v = nullptr) : ScaleName(n)
+    ScaleData(const std::string n, const int *v = nullptr, const layout_t &l = getLayout(12),
+              const comma_registry_t &r = builtInCommas)
+        : ScaleName(n), numDegrees(l.size), lay(&l), reg(&r)
     {
         if (v)
         {
             // only used for streaming
-            for (int d = 0; d < 12; ++d)
+            for (int d = 0; d < numDegrees; ++d)
             {
-                auto c = static_cast<CommaNames>(v[d]);
-                setDegree(d, c);
+                setDegree(d, v[d]);
             }
         }
         else
@@ -187,36 +725,74 @@ struct ScaleData
         }
     }
 
-    virtual void setDegree(const int d, const CommaNames c)
+    const layout_t &layout() const { return *lay; }
+
+    const comma_registry_t &registry() const { return *reg; }
+
+    // c indexes the registry
+    virtual void setDegree(const int d, int c)
     {
-        CC[d] = commas[c];
-        CT[d] = pyth12ratios[d] * CC[d].getRatio(d);
-        CO[d] = pyth12coords[d];
-        auto co = CC[d].getCoord(d);
+        auto &l = layout();
+        c = reg->valid(c);
+        if (!l.takes(c))
+            c = none;
+        CC[d] = (c == syntonic) ? l.rowComma : reg->commas[c];
+        CT[d] = l.ratios[d] * CC[d].getRatio(l.major[d]);
+        CO[d] = l.coords[d];
+        auto co = CC[d].getCoord(l.major[d]);
         CO[d].first += co.first;
         CO[d].second += co.second;
     }
 
     void resetToDefault()
     {
-        for (int d = 0; d < 12; ++d)
+        auto &l = layout();
+        for (int d = 0; d < numDegrees; ++d)
         {
-            CC[d] = defaultCommas[d];
-            CT[d] = pyth12ratios[d] * CC[d].getRatio(d);
-            CO[d] = pyth12coords[d];
-            auto c = CC[d].getCoord(d);
-            CO[d].first += c.first;
-            CO[d].second += c.second;
+            setDegree(d, l.defaults[d]);
+        }
+    }
+
+    // With as many degrees as before, each keeps its comma wherever the new layout
+    // takes it. A different size doesn't line up, so that starts over from the default.
+    // The layout has to outlive us, it's normally the one the processor owns.
+    void setLayout(const layout_t &l)
+    {
+        std::array<int, maxDegrees> kept{};
+        for (int d = 0; d < numDegrees; ++d)
+        {
+            kept[d] = CC[d].nameIndex;
+        }
+
+        bool sameSize = l.size == numDegrees;
+        lay = &l;
+        numDegrees = l.size;
+        if (!sameSize)
+        {
+            resetToDefault();
+            return;
+        }
+
+        for (int d = 0; d < numDegrees; ++d)
+        {
+            setDegree(d, kept[d]);
         }
     }
 
     void setName(const std::string n) { ScaleName = n; }
     std::string ScaleName = "";
-    std::array<comma_t, 12> CC; // Current Commas
-    std::array<double, 12> CT;  // Current Tuning
-    std::array<coord_t, 12> CO; // Current Co-Ordinates
+    int numDegrees{12};
+    std::array<comma_t, maxDegrees> CC; // Current Commas
+    std::array<double, maxDegrees> CT;  // Current Tuning
+    std::array<coord_t, maxDegrees> CO; // Current Co-Ordinates
+
+  private:
+    const layout_t *lay;
+    const comma_registry_t *reg;
 };
 
+// Syntonic mode walks the Duodene's own 3x4 block around, so it only exists
+// for 12 notes on the default 3/2 by 5/4 lattice.
 struct SyntonicData
 {
     SyntonicData() { resetToDefault(); }
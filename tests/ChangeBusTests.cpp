@@ -0,0 +1,90 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#include <array>
+#include <thread>
+
+#include <juce_core/juce_core.h>
+
+#include "ChangeBus.h"
+
+using lattices::ChangeBus;
+
+// Who hears about what, and how often
+struct ChangeBusTests : juce::UnitTest
+{
+    ChangeBusTests() : juce::UnitTest("Change bus", "Lattices") {}
+
+    struct listener_t : ChangeBus::Subscriber
+    {
+        std::array<int, ChangeBus::NumTopics> heard{};
+        void changed(ChangeBus::Topic topic) override { ++heard[topic]; }
+        int total() const
+        {
+            int n{0};
+            for (auto h : heard)
+                n += h;
+            return n;
+        }
+    };
+
+    void runTest() override
+    {
+        ChangeBus bus;
+        listener_t both, tuningOnly;
+        bus.subscribe(ChangeBus::Tuning, &both);
+        bus.subscribe(ChangeBus::Origin, &both);
+        bus.subscribe(ChangeBus::Tuning, &tuningOnly);
+
+        beginTest("Nothing is heard until the next delivery");
+        bus.publish(ChangeBus::Tuning);
+        bus.publish(ChangeBus::Tuning);
+        bus.publish(ChangeBus::Tuning);
+        bus.publish(ChangeBus::Origin);
+        expectEquals(both.total(), 0);
+
+        beginTest("However many there were, each topic is heard once");
+        bus.deliver();
+        expectEquals(both.heard[ChangeBus::Tuning], 1);
+        expectEquals(both.heard[ChangeBus::Origin], 1);
+        expectEquals(both.total(), 2);
+        expectEquals(tuningOnly.heard[ChangeBus::Tuning], 1);
+        expectEquals(tuningOnly.total(), 1);
+        expect(bus.version(ChangeBus::Tuning) == 3);
+        expect(bus.version(ChangeBus::Origin) == 1);
+        expect(bus.version(ChangeBus::Visitors) == 0);
+
+        beginTest("And not at all without a change");
+        bus.deliver();
+        expectEquals(both.total(), 2);
+
+        beginTest("Changes from other threads");
+        bus.subscribe(ChangeBus::Visitors, &both);
+        std::thread audio([&bus] {
+            for (int i = 0; i < 100; ++i)
+                bus.publish(ChangeBus::Visitors);
+        });
+        audio.join();
+        bus.deliver();
+        expectEquals(both.heard[ChangeBus::Visitors], 1);
+        expect(bus.version(ChangeBus::Visitors) == 100);
+
+        beginTest("Unsubscribed means unsubscribed");
+        bus.unsubscribe(&both);
+        bus.publish(ChangeBus::Tuning);
+        bus.deliver();
+        expectEquals(both.heard[ChangeBus::Tuning], 1);
+        expectEquals(tuningOnly.heard[ChangeBus::Tuning], 2);
+        bus.unsubscribe(&tuningOnly);
+    }
+};
+
+static ChangeBusTests changeBusTests;
@@ -0,0 +1,108 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#include <array>
+
+#include <juce_core/juce_core.h>
+
+#include "LatticeGeometry.h"
+#include "ScaleData.h"
+
+namespace lg = lattices::geometry;
+
+// Finding the cell under the mouse again from where it's drawn
+struct LatticeGeometryTests : juce::UnitTest
+{
+    LatticeGeometryTests() : juce::UnitTest("Lattice hit testing", "Lattices") {}
+
+    // as the big lattice sizes them at its default radius
+    static constexpr float radius{26.f};
+    static constexpr float rx{radius * 1.15f};
+    static constexpr float vh{2.f * radius * (5.f / 3.f)};
+
+    // where the lattice's (x, y) is drawn on the component, as the tiles do it
+    static std::pair<float, float> toScreen(const lg::view_t &v, float x, float y)
+    {
+        return {v.width / 2.f + (x - v.xShift) * v.zoom, v.height / 2.f + (y + v.yShift) * v.zoom};
+    }
+
+    bool hits(float x, float y, int w, int v)
+    {
+        auto c = lg::cellAt(x, y, vh, rx, radius);
+        return c && c->first == w && c->second == v;
+    }
+
+    void runTest() override
+    {
+        beginTest("A sphere's centre is its cell");
+        bool all{true};
+        for (int v = -12; v <= 12; ++v)
+        {
+            for (int w = -12; w <= 12; ++w)
+            {
+                auto [x, y] = lg::centreOf(w, v, vh);
+                all = all && hits(x, y, w, v);
+            }
+        }
+        expect(all);
+
+        beginTest("So is anywhere inside it");
+        auto [x, y] = lg::centreOf(3, -2, vh);
+        expect(hits(x + rx * .95f, y, 3, -2));
+        expect(hits(x - rx * .95f, y, 3, -2));
+        expect(hits(x, y + radius * .95f, 3, -2));
+        expect(hits(x, y - radius * .95f, 3, -2));
+        expect(hits(x + rx * .6f, y - radius * .6f, 3, -2));
+
+        beginTest("Between the spheres is nowhere");
+        expect(!lg::cellAt(x + vh * .5f, y, vh, rx, radius));
+        expect(!lg::cellAt(x + vh * .25f, y - vh * .5f, vh, rx, radius));
+        expect(!lg::cellAt(x, y - radius * 1.05f, vh, rx, radius));
+
+        beginTest("Through the view and back");
+        std::array<lg::view_t, 4> views{{{800, 600, 0, 0, 1},
+                                         {800, 600, 431, -97, 1},
+                                         {1024, 700, -250, 380, .37f},
+                                         {640, 480, 77, 12, 2.6f}}};
+        for (auto &view : views)
+        {
+            bool back{true};
+            for (int v = -6; v <= 6; ++v)
+            {
+                for (int w = -6; w <= 6; ++w)
+                {
+                    auto [cx, cy] = lg::centreOf(w, v, vh);
+                    auto [sx, sy] = toScreen(view, cx + rx * .3f, cy - radius * .4f);
+                    auto [lx, ly] = view.toLattice(sx, sy);
+                    back = back && hits(lx, ly, w, v);
+                }
+            }
+            expect(back, "zoomed " + juce::String(view.zoom));
+        }
+
+        beginTest("Jumping takes the root to the cell");
+        auto to = lg::jumpTarget({2, -1}, {5, 0}, {-3, 4}, 24, true);
+        expect(to && to->first == -6 && to->second == 3);
+        to = lg::jumpTarget({20, 0}, {20, 0}, {40, -30}, 24, true);
+        expect(to && to->first == 24 && to->second == -24); // but no further than reach
+
+        beginTest("Not in Syntonic mode");
+        // one step east moves a column of the block, not the root
+        lattices::scaledata::SyntonicData syntonic;
+        syntonic.calculateSteps(1, 0);
+        expect(syntonic.getCoord(0) == lattices::scaledata::coord_t{0, 0});
+        syntonic.calculateSteps(2, 0);
+        expect(syntonic.getCoord(0) == lattices::scaledata::coord_t{4, -1});
+        expect(!lg::jumpTarget({0, 0}, {0, 0}, {1, 0}, 24, false));
+    }
+};
+
+static LatticeGeometryTests latticeGeometryTests;
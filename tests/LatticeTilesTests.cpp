@@ -0,0 +1,108 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#include <array>
+#include <atomic>
+
+#include <juce_graphics/juce_graphics.h>
+
+#include "LatticeTiles.h"
+
+namespace lt = lattices::tiles;
+
+// Which tiles the cache keeps, and the workers that draw them
+struct LatticeTilesTests : juce::UnitTest
+{
+    LatticeTilesTests() : juce::UnitTest("Lattice tiles", "Lattices") {}
+
+    // as the lattice does once it's drawn one
+    static lt::TileCache::tile_t &draw(lt::TileCache &c, int x, int y)
+    {
+        auto &t = c.get(x, y);
+        t.valid = true;
+        return t;
+    }
+
+    void runTest() override
+    {
+        beginTest("New tiles come back to be drawn");
+        lt::TileCache cache;
+        cache.reserve(3);
+        auto &a = cache.get(0, 0);
+        expect(!a.valid);
+        expect(a.x == 0 && a.y == 0);
+        expect(a.image.isValid());
+        expectEquals(a.image.getWidth(), lt::TileCache::tileSize);
+
+        beginTest("Drawn tiles are kept");
+        lt::TileCache lru;
+        lru.reserve(3);
+        auto *t0 = &draw(lru, 0, 0);
+        auto *t1 = &draw(lru, 1, 0);
+        auto *t2 = &draw(lru, 2, 0);
+        expect(t0 != t1 && t1 != t2 && t0 != t2);
+        lru.nextFrame();
+        expect(&lru.get(0, 0) == t0 && t0->valid);
+        expect(&lru.get(2, 0) == t2 && t2->valid);
+
+        beginTest("The least recently used one goes first");
+        lru.nextFrame();
+        auto &t3 = lru.get(3, 0);
+        expect(&t3 == t1); // (1, 0) wasn't asked for last frame
+        expect(!t3.valid && t3.x == 3 && t3.y == 0);
+        t3.valid = true;
+        lru.nextFrame();
+        expect(&lru.get(0, 0) == t0 && t0->valid);
+        expect(&lru.get(2, 0) == t2 && t2->valid);
+        expect(!lru.get(1, 0).valid); // so it has to be drawn again
+
+        beginTest("Undrawn tiles go before any drawn one");
+        lt::TileCache spare;
+        spare.reserve(3);
+        auto *s0 = &draw(spare, 0, 0);
+        auto *s1 = &draw(spare, 0, 1);
+        spare.nextFrame();
+        auto &s2 = spare.get(0, 2);
+        expect(&s2 != s0 && &s2 != s1);
+
+        beginTest("A new scale means drawing everything again");
+        spare.setScale(1.f);
+        expect(s0->valid && s1->valid);
+        spare.setScale(2.f);
+        expect(!s0->valid && !s1->valid);
+        expectEquals(spare.scale(), 2.f);
+
+        beginTest("Every tile gets drawn, once, by a thread in its own slot");
+        lt::TileWorkers workers;
+        expect(lt::TileWorkers::numSlots() >= 2 && lt::TileWorkers::numSlots() <= 8);
+        for (int n : {0, 1, 2, 7, 64})
+        {
+            std::array<std::atomic<int>, 64> drawn{};
+            std::array<std::atomic<bool>, 8> busy{};
+            std::atomic<bool> shared{false};
+            workers.run(n,
+                        [&](int i, int slot)
+                        {
+                            if (busy[slot].exchange(true)) // someone else is in our slot
+                                shared = true;
+                            ++drawn[i];
+                            busy[slot] = false;
+                        });
+            bool once{true};
+            for (int i = 0; i < 64; ++i)
+                once = once && drawn[i] == (i < n ? 1 : 0);
+            expect(once, juce::String(n) + " tiles");
+            expect(!shared, juce::String(n) + " tiles");
+        }
+    }
+};
+
+static LatticeTilesTests latticeTilesTests;
@@ -0,0 +1,235 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#include <string>
+
+#include <juce_core/juce_core.h>
+
+#include "JIMath.h"
+#include "ScaleData.h"
+
+namespace sd = lattices::scaledata;
+
+// How the scale sizes and generators lay out on the lattice
+struct LayoutTests : juce::UnitTest
+{
+    LayoutTests() : juce::UnitTest("Lattice layouts", "Lattices") {}
+
+    void runTest() override
+    {
+        beginTest("Patent vals");
+        expectEquals(sd::patentVal(12, 3, 2), 7);
+        expectEquals(sd::patentVal(12, 5, 4), 4);
+        expectEquals(sd::patentVal(12, 7, 4), 10);
+        expectEquals(sd::patentVal(12, 11, 8), 6);
+        expectEquals(sd::patentVal(31, 3, 2), 18);
+        expectEquals(sd::patentVal(31, 5, 4), 10);
+        expectEquals(sd::patentVal(13, 5, 3, {3, 1}), 6); // Bohlen-Pierce
+
+        beginTest("The tables are what building them gives");
+        for (int size : sd::scaleSizes)
+        {
+            auto &table = sd::getLayout(size);
+            auto built = sd::makeLayout(size, sd::patentVal(size, 3, 2), sd::patentVal(size, 5, 4),
+                                        table.chainStart, table.extraSteps);
+            expectEquals(built.fifthSteps, table.fifthSteps);
+            expectEquals(built.thirdSteps, table.thirdSteps);
+            for (int d = 0; d < size; ++d)
+            {
+                expect(built.fractions[d] == table.fractions[d]);
+                expect(built.coords[d] == table.coords[d]);
+            }
+        }
+
+        beginTest("Every degree sits where degreeAt() says it does");
+        for (int size : sd::scaleSizes)
+        {
+            auto &l = sd::getLayout(size);
+            std::array<bool, sd::maxDegrees> seen{};
+            for (int d = 0; d < size; ++d)
+            {
+                expectEquals(l.degreeAt(l.coords[d].first, l.coords[d].second), d);
+                seen[d] = true;
+            }
+            for (int d = 0; d < size; ++d)
+                expect(seen[d]);
+        }
+
+        beginTest("The default generators give back the table");
+        auto same = sd::buildLayout(12, {3, 2}, {5, 4});
+        expect(same.rowComma.getFraction(true) == sd::frac_t{80, 81});
+        expect(same.rowComma.getCoord(true) == sd::coord_t{-4, 1});
+        for (int d = 0; d < 12; ++d)
+            expect(same.fractions[d] == sd::pyth12fractions[d]);
+
+        beginTest("Septimal thirds");
+        auto sept = sd::buildLayout(12, {3, 2}, {7, 4});
+        expectEquals(sept.thirdSteps, 10);
+        // 16/9 sits west of the root, and its row comma takes it up to 7/4
+        expect(sept.rowComma.getFraction(false) == sd::frac_t{63, 64});
+        expect(sept.rowComma.getCoord(false) == sd::coord_t{2, 1});
+        expectEquals(sept.rowPrime, 7);
+        expect(!sept.builtInVisitors);
+
+        beginTest("Walking around the octave comes back a pythagorean comma out");
+        auto &twelve = sd::getLayout(12);
+        expectWithinAbsoluteError(twelve.walks[0].comma, 531441.0 / 524288.0, 1e-12);
+
+        beginTest("Cell ratios");
+        JIMath jim;
+        expect(jim.cellRatio(1, 0) == std::make_pair<uint64_t, uint64_t>(3, 2));
+        expect(jim.cellRatio(0, 1) == std::make_pair<uint64_t, uint64_t>(5, 4));
+        expect(jim.cellRatio(1, 1) == std::make_pair<uint64_t, uint64_t>(15, 8));
+        expect(jim.cellRatio(-1, 0) == std::make_pair<uint64_t, uint64_t>(4, 3));
+        expect(jim.cellRatio(4, -1) == std::make_pair<uint64_t, uint64_t>(81, 80));
+
+        jim.setGenerators(3, 2, 7, 4);
+        expect(jim.cellRatio(0, 1) == std::make_pair<uint64_t, uint64_t>(7, 4));
+        expect(jim.cellRatio(1, 1) == std::make_pair<uint64_t, uint64_t>(21, 16));
+    }
+};
+
+static LayoutTests layoutTests;
+
+// Periods other than the octave, and which generators fit in them
+struct PeriodTests : juce::UnitTest
+{
+    PeriodTests() : juce::UnitTest("Lattice periods", "Lattices") {}
+
+    void runTest() override
+    {
+        beginTest("Which generators fit");
+        expect(sd::generatorsFit(12, {3, 2}, {5, 4}));
+        expect(sd::generatorsFit(12, {3, 2}, {7, 4}));
+        expect(!sd::generatorsFit(12, {3, 2}, {7, 4}, {3, 2})); // 7/4 is past the period
+        expect(!sd::generatorsFit(12, {3, 2}, {5, 4}, {3, 2})); // and 3/2 is the period
+        expect(!sd::generatorsFit(12, {2, 3}, {5, 4}));         // everything goes up
+        expect(!sd::generatorsFit(12, {3, 2}, {5, 4}, {1, 1}));
+        expect(!sd::generatorsFit(12, {9, 8}, {5, 4})); // 2 steps of 12, which skip half
+
+        beginTest("A misfit gets the table layout");
+        auto misfit = sd::buildLayout(12, {3, 2}, {7, 4}, {3, 2});
+        expect(misfit.diagonal == sd::frac_t{5, 4});
+        expect(misfit.period == sd::frac_t{2, 1});
+
+        beginTest("Bohlen-Pierce lays out inside the tritave");
+        auto bp = sd::buildLayout(13, {5, 3}, {7, 5}, {3, 1});
+        expect(bp.period == sd::frac_t{3, 1});
+        expectWithinAbsoluteError(bp.periodPowers[sd::periodReach + 1], 3.0, 1e-12);
+        expectWithinAbsoluteError(bp.periodPowers[sd::periodReach - 2], 1.0 / 9.0, 1e-12);
+        for (int d = 0; d < bp.size; ++d)
+        {
+            auto [n, dn] = bp.fractions[d];
+            expect(n >= dn && n < 3 * dn, "degree " + juce::String(d) + " is out of the period");
+        }
+        expectEquals(bp.rowPrime, 7);
+
+        beginTest("Reducing by the period");
+        JIMath jim;
+        jim.setPeriod(3, 1);
+        uint64_t n{5}, d{1};
+        jim.octaveReduceRatio(n, d);
+        expect(n == 5 && d == 3);
+        n = 1;
+        d = 2;
+        jim.octaveReduceRatio(n, d);
+        expect(n == 3 && d == 2);
+    }
+};
+
+static PeriodTests periodTests;
+
+// The commas visitors can be, ours and the user's
+struct RegistryTests : juce::UnitTest
+{
+    RegistryTests() : juce::UnitTest("Comma registry", "Lattices") {}
+
+    void runTest() override
+    {
+        beginTest("The built in commas");
+        auto &ours = sd::builtInCommas;
+        expectEquals(ours.size, sd::numBuiltInCommas);
+        expectEquals(ours.numOffered, sd::novemdecimal + 1);
+        expectEquals(ours.buttonOf[sd::novemdecimal], static_cast<int>(sd::novemdecimal));
+        expectEquals(ours.buttonOf[sd::twentythree], -1);
+        expectEquals(juce::String(ours.labels[sd::septimal].data()), juce::String("7"));
+        for (int c = 0; c < ours.size; ++c)
+            expectEquals(ours.commas[c].nameIndex, c);
+
+        beginTest("Labels fit whole, or are cut between characters");
+        expect(sd::glyphFits("1053/1024"));
+        expectEquals(juce::String(sd::makeGlyph("1053/1024").data()), juce::String("1053/1024"));
+        expect(sd::glyphFits("\xF0\x9D\x84\xAA")); // a double sharp, four bytes
+        expect(!sd::glyphFits("3486784401/3435973836 and then some"));
+        // 30 bytes then a three byte character, which would end one past the room for it
+        std::string cut(30, 'x');
+        cut += "\xE2\x99\xAF";
+        expect(!sd::glyphFits(cut.c_str()));
+        expectEquals(std::string(sd::makeGlyph(cut.c_str()).data()), std::string(30, 'x'));
+
+        beginTest("User commas go on the end until it's full");
+        auto reg = sd::builtInCommas;
+        for (int i = 0; i < sd::maxUserCommas; ++i)
+            expect(reg.add({reg.size, {1053, 1024}, {-4, 1}}, "13/8", "^", "v"));
+        expect(!reg.add({reg.size, {1053, 1024}, {-4, 1}}, "13/8", "^", "v"));
+        expectEquals(reg.size, sd::maxCommas);
+        expectEquals(reg.numOffered, sd::novemdecimal + 1 + sd::maxUserCommas);
+        expectEquals(reg.buttonOf[sd::numBuiltInCommas], sd::novemdecimal + 1);
+        expectEquals(reg.commas[sd::numBuiltInCommas].nameIndex, sd::numBuiltInCommas);
+
+        beginTest("Unknown commas are no comma");
+        expectEquals(reg.valid(-1), static_cast<int>(sd::none));
+        expectEquals(reg.valid(sd::maxCommas), static_cast<int>(sd::none));
+        expectEquals(sd::builtInCommas.valid(sd::numBuiltInCommas), static_cast<int>(sd::none));
+
+        beginTest("Visitors are tuned and placed from the registry");
+        auto &l = sd::getLayout(12);
+        sd::ScaleData group{"test", nullptr, l, reg};
+        int e = 4; // 81/64, major
+        group.setDegree(e, sd::numBuiltInCommas);
+        expectEquals(group.CC[e].nameIndex, sd::numBuiltInCommas);
+        expectWithinAbsoluteError(group.CT[e], 81.0 / 64.0 * 1053.0 / 1024.0, 1e-12);
+        expect(group.CO[e] == sd::coord_t{0, 1});
+
+        group.setDegree(e, sd::maxCommas + 3);
+        expectEquals(group.CC[e].nameIndex, static_cast<int>(sd::none));
+        expect(group.CO[e] == sd::coord_t{4, 0});
+
+        beginTest("Layouts without a place for ours keep only the user's");
+        auto sept = sd::buildLayout(12, {3, 2}, {7, 4});
+        sd::ScaleData septGroup{"test", nullptr, sept, reg};
+        septGroup.setDegree(e, sd::septimal);
+        expectEquals(septGroup.CC[e].nameIndex, static_cast<int>(sd::none));
+        septGroup.setDegree(e, sd::numBuiltInCommas);
+        expectEquals(septGroup.CC[e].nameIndex, sd::numBuiltInCommas);
+
+        beginTest("A new layout of the same size keeps what it can take");
+        sd::ScaleData moved{"test", nullptr, l, reg};
+        int a = 9; // 27/16, major
+        moved.setDegree(e, sd::numBuiltInCommas);
+        moved.setDegree(a, sd::septimal);
+        moved.setLayout(sept);
+        expectEquals(moved.CC[e].nameIndex, sd::numBuiltInCommas);
+        expectEquals(moved.CC[a].nameIndex, static_cast<int>(sd::none));
+        expectWithinAbsoluteError(moved.CT[e], sept.ratios[e] * 1053.0 / 1024.0, 1e-12);
+
+        beginTest("And another size starts over");
+        auto &thirteen = sd::getLayout(13);
+        moved.setLayout(thirteen);
+        expectEquals(moved.numDegrees, 13);
+        bool byDefault{true};
+        for (int d = 0; d < 13; ++d)
+            byDefault = byDefault && moved.CC[d].nameIndex == thirteen.defaults[d];
+        expect(byDefault);
+    }
+};
+
+static RegistryTests registryTests;
@@ -0,0 +1,30 @@
+/*
+  Lattices - A Just-Intonation graphical MTS-ESP Source
+
+  Copyright 2023-2024 Andreya Ek Frisk and Paul Walker.
+
+  This code is released under the MIT licence, but do note that it depends
+  on the JUCE library, see licence for more details.
+
+  Source available at https://github.com/Andreya-Autumn/lattices
+*/
+
+#include <juce_events/juce_events.h>
+
+// Every test registers itself in the "Lattices" category, see the other files
+// in here. Anything failing fails the run, so ctest sees it.
+int main()
+{
+    // we're the message thread, for whatever needs one
+    [[maybe_unused]] juce::ScopedJuceInitialiser_GUI init;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("Lattices");
+
+    int failures{0};
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}